@@ -38,8 +38,10 @@ uint8_t TwoWire::txBufferIndex = 0;
 uint8_t TwoWire::txBufferLength = 0;
 
 uint8_t TwoWire::transmitting = 0;
+#ifdef TWI_SLAVE
 void (*TwoWire::user_onRequest)(void);
 void (*TwoWire::user_onReceive)(int);
+#endif
 
 // Constructors ////////////////////////////////////////////////////////////////
 
@@ -60,6 +62,7 @@ void TwoWire::begin(void)
   twi_init();
 }
 
+#ifdef TWI_SLAVE
 void TwoWire::begin(uint8_t address)
 {
   twi_setAddress(address);
@@ -72,6 +75,7 @@ void TwoWire::begin(int address)
 {
   begin((uint8_t)address);
 }
+#endif
 
 uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
 {
@@ -137,11 +141,14 @@ void TwoWire::send(uint8_t data)
     ++txBufferIndex;
     // update amount in buffer   
     txBufferLength = txBufferIndex;
-  }else{
+  }
+#ifdef TWI_SLAVE
+  else{
   // in slave send mode
     // reply to master
     twi_transmit(&data, 1);
   }
+#endif
 }
 
 // must be called in:
@@ -154,11 +161,14 @@ void TwoWire::send(uint8_t* data, uint8_t quantity)
     for(uint8_t i = 0; i < quantity; ++i){
       send(data[i]);
     }
-  }else{
+  }
+#ifdef TWI_SLAVE
+  else{
   // in slave send mode
     // reply to master
     twi_transmit(data, quantity);
   }
+#endif
 }
 
 // must be called in:
@@ -203,6 +213,7 @@ uint8_t TwoWire::receive(void)
   return value;
 }
 
+#ifdef TWI_SLAVE
 // behind the scenes function that is called when data is received
 void TwoWire::onReceiveService(uint8_t* inBytes, int numBytes)
 {
@@ -254,6 +265,7 @@ void TwoWire::onRequest( void (*function)(void) )
 {
   user_onRequest = function;
 }
+#endif
 
 // Preinstantiate Objects //////////////////////////////////////////////////////
 
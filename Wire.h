@@ -37,15 +37,19 @@ class TwoWire
     static uint8_t txBufferLength;
 
     static uint8_t transmitting;
+#ifdef TWI_SLAVE
     static void (*user_onRequest)(void);
     static void (*user_onReceive)(int);
     static void onRequestService(void);
     static void onReceiveService(uint8_t*, int);
+#endif
   public:
     TwoWire();
     void begin();
+#ifdef TWI_SLAVE
     void begin(uint8_t);
     void begin(int);
+#endif
     void beginTransmission(uint8_t);
     void beginTransmission(int);
     uint8_t endTransmission(void);
@@ -57,8 +61,10 @@ class TwoWire
     void send(char*);
     uint8_t available(void);
     uint8_t receive(void);
+#ifdef TWI_SLAVE
     void onReceive( void (*)(int) );
     void onRequest( void (*)(void) );
+#endif
 };
 
 extern TwoWire Wire;
@@ -1,135 +1,275 @@
 /**This library implements the I2C protocol for communication with the GY-521
  * breakout board.  This sensor is contains an accelerometer, gyroscope, and
  * thermometer.  The library is designed for use with a small Mickey Mouse
- * plush, and only uses the accelerometer, so the other features are not
- * implemented in this code.  The sensors address, as well as the addresses
- * for its more important registers are listed in the preprocessor commands.
+ * plush.  The accelerometer and gyroscope are read together for the
+ * posture filter, and the thermometer is used when THERM_IMU is defined.
+ * The sensors address, as well as the addresses for its more important
+ * registers are listed in the preprocessor commands.
  * Additionally, the standard accelerometer usage is for plus or minus 2g.
  * The function accel() gives the magnitude of the acceleration, disregarding
  * the direction.
  */
-#include "Wire.h"
+#include <avr/pgmspace.h>
+#include <string.h>
 #include "accelerometer.h"
 #include "servo.h"
+#include "events.h"
+#include "fsm.h"
+#include "clock.h"
+#include "i2cbus.h"
+#include "thermometer.h"
+#include "posture.h"
+#include "settings.h"
+#include "boot.h"
 
-//Register adresses
+//Register adresses.  A second sensor, with AD0 pulled high, is at 0x69
+#ifndef ACCEL_ADDR
 #define ACCEL_ADDR 0x68
+#endif
 #define ACCEL_XOUT_H 0X3B
 #define ACCEL_XOUT_L 0x3C
 #define ACCEL_YOUT_H 0x3D
 #define ACCEL_YOUT_L 0x3E
 #define ACCEL_ZOUT_H 0x3F
 #define ACCEL_ZOUT_L 0x40
+#define TEMP_OUT_H 0x41
+#define TEMP_OUT_L 0x42
+#define GYRO_XOUT_H 0x43
+#define GYRO_XOUT_L 0x44
+#define GYRO_YOUT_H 0x45
+#define GYRO_YOUT_L 0x46
+#define SMPLRT_DIV 0x19
+#define DLPF_CONFIG 0x1A
+#define GYRO_CONFIG 0x1B
+#define ACCEL_CONFIG 0x1C
+#define MOT_THR 0x1F
+#define MOT_DUR 0x20
+#define INT_PIN_CFG 0x37
+#define INT_ENABLE 0x38
+#define INT_STATUS 0x3A
+#define PWR_MGMT_1 0x6B
+#define PWR_MGMT_2 0x6C
 
-#define ACCEL_THRESHOLD >0xF900
+//The axes are read in one burst, from ACCEL_XOUT_H on past the temperature
+//to GYRO_YOUT_L, so the posture filter and the thermometer cost no more
+//transactions.  The gyroscope's z axis isn't used
+#define BYTES_PER_READ (GYRO_YOUT_L-ACCEL_XOUT_H+1)
 
-//The number of bytes to read on a single I2C transaction
-#define BYTES_PER_READ 2
+//The axes are read once per tick, at the rate the posture filter assumes,
+//and must have arrived within a few milliseconds of falling due for the
+//shake to be seen on time
+#define ACCEL_PERIOD_MS POSTURE_PERIOD_MS
+#define ACCEL_DEADLINE_MS 4
 
-/**Writes "message" to register "reg" of the GY-521
+/**The latest burst of axis readings, kept up to date by the bus manager
  */
-void writeI2C(int reg, int message)
+static unsigned char sample[BYTES_PER_READ];
+static unsigned char sampled;
 
+/**Returns the 16 bit reading that starts at register "reg".  The word is
+ * put together unsigned, as the high byte would overflow a signed int, and
+ * only then taken as signed
+ */
+static int sampleWord(unsigned char reg)
+  {return (int)(((unsigned int)sample[reg-ACCEL_XOUT_H]<<8)|sample[reg-ACCEL_XOUT_H+1]);}
+
+/**Passes each good burst to the posture filter, and the temperature
+ * to the thermometer
+ */
+static void burstDone(i2cTransaction* t)
 {
-  Wire.beginTransmission(ACCEL_ADDR);
-  Wire.send(reg);
-  Wire.send(message);
-  Wire.endTransmission();
+  if(t->status!=I2C_OK) return;
+  sampled=1;
+  bootMark(BOOT_FIRST_SAMPLE);
+  postureSample((signed char)sample[ACCEL_XOUT_H-ACCEL_XOUT_H],
+                (signed char)sample[ACCEL_YOUT_H-ACCEL_XOUT_H],
+                (signed char)sample[ACCEL_ZOUT_H-ACCEL_XOUT_H],
+                sampleWord(GYRO_XOUT_H),sampleWord(GYRO_YOUT_H));
+#ifdef THERM_IMU
+  thermImuSample(sampleWord(TEMP_OUT_H));
+#endif
 }
 
-/**Reads "BYTES_PER_READ" bytes from the register "reg"
- * The register value is returned as a signed int
+static i2cTransaction axisRead=
+  {ACCEL_ADDR,ACCEL_XOUT_H,I2C_READ,I2C_PRIORITY_CRITICAL,sample,BYTES_PER_READ,
+   ACCEL_PERIOD_MS,ACCEL_DEADLINE_MS,burstDone};
+
+/**The profiles, as the values of SMPLRT_DIV, CONFIG, GYRO_CONFIG and
+ * ACCEL_CONFIG, which are consecutive registers.  With the low pass filter
+ * on, the sensor samples at 1kHz/(1+SMPLRT_DIV), so a divider of 15 gives
+ * 62.5Hz, one sample for each 16ms read.  The filters are below half that
+ * rate, so a read never sees motion faster than it can follow
  */
-signed int readI2C(int reg)
+#define PROFILE_BYTES (ACCEL_CONFIG-SMPLRT_DIV+1)
+static const unsigned char accelProfiles[][PROFILE_BYTES] PROGMEM=
 {
-  Wire.beginTransmission(ACCEL_ADDR);
-  Wire.send(reg);
-  Wire.endTransmission();
-  
-  Wire.beginTransmission(ACCEL_ADDR);
-  Wire.requestFrom(ACCEL_ADDR,BYTES_PER_READ);
-  signed int data=Wire.receive();
-  Wire.endTransmission();
-  
-  return data;
-}
+  {15,4,0,0},  //ACCEL_PROFILE_TICK: 21Hz, delayed 8.5ms
+  {15,5,0,0},  //ACCEL_PROFILE_SMOOTH: 10Hz, delayed 13.8ms
+  {0,0,0,0},   //ACCEL_PROFILE_RAW: 260Hz, sampled at 8kHz
+};
+
+//The times each transaction of the set up must be done by, so that
+//they are run in order (in milliseconds after setUpAccel())
+#define ACCEL_WAKE_MS 10
+#define ACCEL_WRITE_MS 20
+#define ACCEL_CHECK_MS 30
 
-/**These variables are set during the call of setUpAccel().
- * They are used as an offset in the rest of the measurements.
- * As long as the accelerometer is not rotated, they will represent
- * a gravitational offset, so that the exact value can be found
+//The tries at writing the profile.  One retry covers a write garbled by
+//noise on the bus
+#define ACCEL_PROFILE_TRIES 2
+
+static int configured;
+static unsigned char tries;
+
+int accelConfigured()
+  {return configured;}
+
+/**The set up is done by the bus manager as one-shot transactions, so the
+ * sensor is woken and configured on the first tick, while the rest of the
+ * robot has been set up, instead of setup waiting on the bus.  The sensor
+ * is woken, with every sensor on, then sent the profile in one burst,
+ * which is read back in another
  */
-signed int xBase;
-signed int yBase;
-signed int zBase;
+static unsigned char wake[3]={PWR_MGMT_1,0x00,0x00};
+static unsigned char profile[PROFILE_BYTES+1];
+static unsigned char check[PROFILE_BYTES];
+static void profileChecked(i2cTransaction* t);
+
+static i2cTransaction wakeWrite=
+  {ACCEL_ADDR,0,I2C_WRITE,I2C_PRIORITY_NORMAL,wake,3,0,ACCEL_WAKE_MS,0};
+static i2cTransaction profileWrite=
+  {ACCEL_ADDR,0,I2C_WRITE,I2C_PRIORITY_NORMAL,profile,PROFILE_BYTES+1,0,ACCEL_WRITE_MS,0};
+static i2cTransaction profileRead=
+  {ACCEL_ADDR,SMPLRT_DIV,I2C_READ,I2C_PRIORITY_NORMAL,check,PROFILE_BYTES,0,ACCEL_CHECK_MS,profileChecked};
 
+/**Starts reading the axes once the sensor has kept every byte of the
+ * profile, or once it has had all its tries
+ */
+static void profileChecked(i2cTransaction* t)
+{
+  configured=t->status==I2C_OK && !memcmp(check,profile+1,PROFILE_BYTES);
+  if(!configured && ++tries<ACCEL_PROFILE_TRIES)
+  {
+    i2cAdd(&profileWrite);
+    i2cAdd(&profileRead);
+    return;
+  }
+  i2cAdd(&axisRead);
+}
 
+/**The offsets settings.xBase, yBase and zBase are taken from the axes by
+ * readAxis(), so accel() measures the change from the robot at rest.  As
+ * long as the accelerometer is not rotated, they are the pull of gravity
+ * and the sensor's own offsets.  They are kept in EEPROM, so they are
+ * ready at once on the next boot, before the sensor has settled
+ */
 void calibrate()
 {
-  xBase=readI2C(ACCEL_XOUT_H);
-  yBase=readI2C(ACCEL_YOUT_H);
-  zBase=readI2C(ACCEL_ZOUT_H);
+  settings.xBase=sampleWord(ACCEL_XOUT_H);
+  settings.yBase=sampleWord(ACCEL_YOUT_H);
+  settings.zBase=sampleWord(ACCEL_ZOUT_H);
+  settings.calibrated=1;
+  settingsChanged();
+  bootMark(BOOT_CALIBRATED);
 }
 
-/**Turns on the sensor to begin acceleration measurements.  Also
- * calibrates for gravity.
+/**Queues the transactions that wake the sensor, set the filter, the
+ * sample rate and the sensitivity to 2g's, and then leave the bus manager
+ * reading the axes every tick.  Nothing is sent until the first tick.
+ * setUpI2C() and loadSettings() must have been called.
  */
 void setUpAccel()
 {
-  //Set the sensitivity to 2g's
-  writeI2C(0x1C,0x00);
+  profile[0]=SMPLRT_DIV;
+  for(unsigned char i=0;i<PROFILE_BYTES;i++)
+    profile[i+1]=pgm_read_byte(&accelProfiles[ACCEL_PROFILE][i]);
+  i2cAdd(&wakeWrite);
+  i2cAdd(&profileWrite);
+  i2cAdd(&profileRead);
+}
 
-  //Wake up the sensor
-  writeI2C(0x6B,0x00);
+/**Sends the bytes to consecutive registers, starting at bytes[0], and
+ * waits for them to be written
+ */
+static void sendNow(unsigned char* bytes, unsigned char length)
+{
+  i2cTransaction t={ACCEL_ADDR,0,I2C_WRITE,I2C_PRIORITY_CRITICAL,bytes,length,0,0,0};
+  i2cRun(&t);
+}
 
-  //Find the gravitational offset
-  calibrate();
+/**This follows the datasheet's order for motion detection.  The high pass
+ * filter takes out gravity, so only a change is seen, and INT is active
+ * low and latched, because only a low level can wake the ATmega from
+ * power down.  INT_STATUS is read last, to clear any motion seen while
+ * this was set up
+ */
+void accelSleep()
+{
+  i2cRemove(&axisRead);
+  i2cRemove(&wakeWrite);
+  i2cRemove(&profileWrite);
+  i2cRemove(&profileRead);
+
+  unsigned char filter[2]={ACCEL_CONFIG,0x01};
+  unsigned char motion[3]={MOT_THR,ACCEL_MOTION_THRESHOLD,1};
+  unsigned char interrupt[3]={INT_PIN_CFG,0xA0,0x40};
+  //CYCLE with the temperature sensor off, and the gyroscopes in standby
+  unsigned char power[3]={PWR_MGMT_1,0x28,(ACCEL_MOTION_RATE<<6)|0x07};
+  sendNow(filter,2);
+  sendNow(motion,3);
+  sendNow(interrupt,3);
+  sendNow(power,3);
+
+  unsigned char status;
+  i2cTransaction t={ACCEL_ADDR,INT_STATUS,I2C_READ,I2C_PRIORITY_CRITICAL,&status,1,0,0,0};
+  i2cRun(&t);
+}
+
+/**Waking leaves the motion interrupt on, but nothing listens to it while
+ * the robot is awake.  The gyroscopes start up within the first few reads
+ */
+void accelWake()
+{
+  tries=0;
+  i2cAdd(&wakeWrite);
+  i2cAdd(&profileWrite);
+  i2cAdd(&profileRead);
 }
 
-/**Reads the indicated axis (x=1, y=2, z=3) and
- * subtracts the gravitaitonal offset
+/**Returns the latest reading of the indicated axis (x=1, y=2, z=3), less
+ * its calibrated base, in the sensor's units, ACCEL_G to a g.  The change
+ * can be twice the sensor's range, so it is held within an int
  */
 signed int readAxis(int axis)
 {
-  if(axis==1) return readI2C(ACCEL_XOUT_H);//-xBase;
-  else if(axis==2) return readI2C(ACCEL_YOUT_H);//-yBase;
-  else return readI2C(ACCEL_ZOUT_H);//-zBase;
+  long change;
+  if(axis==1) change=(long)sampleWord(ACCEL_XOUT_H)-settings.xBase;
+  else if(axis==2) change=(long)sampleWord(ACCEL_YOUT_H)-settings.yBase;
+  else change=(long)sampleWord(ACCEL_ZOUT_H)-settings.zBase;
+  if(change>32767) return 32767;
+  if(change<-32767) return -32767;
+  return (int)change;
 }
 
-/**My own square root function.
+/**My own square root function.  It finds the root a bit at a time, from
+ * the top, so it is exact (rounded down) for any 32 bit input
  */
 unsigned int mySqrt(unsigned long in)
 {
-  //If the number is large, we set mult to 0xFFFF, essentially dropping
-  //the least precise 16 bits, and taking the square root of the more
-  //significant bits
-  int mult;
-  if(in>0xFFFFF) mult=0xFFFF;
-  else mult=1;
-  int x=in/mult;
-
-  //Use a lookup table for input of 0 and 1, because these numbers produce
-  //less accurate results with the main algorithm
-  if(in==0) return 0;
-  else if(in==1) return 1;
-  else
+  unsigned long root=0;
+  unsigned long bit=1UL<<30;
+  while(bit>in) bit>>=2;
+  while(bit)
   {
-    //We initially guess that the square root is 1
-    int guess=1;
-    
-    //We use determine log(in)/4.  Then, we can raise
-    //e^2 to that power, and that should be the square root.
-    //That's why we call the variable "exponenet"
-    int exponent=1.93+3*in/100000-3*in*in/10000000000;
-    
-    //e^2 is approximately 7, so we raise it to the "exponent" power
-    for(int i=0;i<exponent;i++) guess*=7;
-    
-    //The above has givenus a decent estimate for the square root.    
-    //Now, we use a Taylor series error approximation to refine the guess
-    for(int i=0;i<4;i++) guess+=(in-guess*guess)/2/guess;
-    return guess;
+    if(in>=root+bit)
+    {
+      in-=root+bit;
+      root=(root>>1)+bit;
+    }
+    else root>>=1;
+    bit>>=2;
   }
+  return root;
 }
 
 unsigned int accel()
@@ -139,8 +279,11 @@ unsigned int accel()
   signed int axY=readAxis(2);
   signed int axZ=readAxis(3);
   
-  //Return the quadrature sum of the axes measurements
-  unsigned long sum=axX*axX+axY*axY+axZ*axZ;
+  //Return the quadrature sum of the axes measurements.  Each square is
+  //at most 2^30, so the sum fits unsigned
+  unsigned long sum=(unsigned long)((long)axX*axX);
+  sum+=(unsigned long)((long)axY*axY);
+  sum+=(unsigned long)((long)axZ*axZ);
   return mySqrt(sum);
 }
 
@@ -149,67 +292,88 @@ int accelerated=0;
 
 int accelerating(){return accelerated;}
 
-enum accel_ST {init_ACCEL,waitForStart_ACCEL,delayForNextSense_ACCEL,recalibrate_ACCEL};
+enum accel_ST {init_ACCEL,waitForStart_ACCEL,delayForNextSense_ACCEL,recalibrate_ACCEL,settle_ACCEL};
+
+//How long accelerating() reports a shake, and how long between the two
+//measurements that decide whether to recalibrate, which is also the
+//least time the sensor is left to settle before it is first calibrated
+//(in milliseconds)
+#define ACCEL_SHAKE_MS 100
+#define ACCEL_RECALIBRATE_MS 2000
+
+//The most accel() may change over ACCEL_RECALIBRATE_MS for the robot to
+//be taken as still, and recalibrated (about a hundredth of a g)
+#define ACCEL_STILL 200
+
+static unsigned int delayStart;
+static unsigned int calibrationMeasurement;
+
+static int wasCalibrated(){return settings.calibrated;}
+static int shakeDetected(){return accel()>settings.shakeThreshold;}
+static int senseDelayDone(){return clockElapsed(delayStart,settings.senseDelayMs);}
+static int recalibrateDelayDone(){return clockElapsed(delayStart,ACCEL_RECALIBRATE_MS);}
+
+/**The first calibration waits for the sensor to settle, and then for an
+ * idle tick, when the joints are still and so is the robot
+ */
+static int settled()
+  {return recalibrateDelayDone() && sampled && spineAtTarget() && leftAtTarget() && rightAtTarget();}
+
+static void useStoredBases()
+{
+  accelerated=0;
+  bootMark(BOOT_CALIBRATED);
+}
+static void startSettle(){delayStart=clockNow();}
+
+static void reportShake()
+{
+  accelerated=1;
+  delayStart=clockNow();
+  postEvent(&taskEvents,SHAKE_EVENT,0);
+}
+
+static void clearAccelerated(){accelerated=0;}
+
+static void startRecalibration()
+{
+  delayStart=clockNow();
+  calibrationMeasurement=accel();
+}
+
+/**A shake can leave the robot in a new pose, with gravity pulling on
+ * other axes.  If it has kept still since, the bases are taken again
+ */
+static void recalibrate()
+{
+  unsigned int currentAccel=accel();
+  unsigned int change=currentAccel>calibrationMeasurement?
+    currentAccel-calibrationMeasurement:calibrationMeasurement-currentAccel;
+  if(change<ACCEL_STILL) calibrate();
+}
+
+static void endShake()
+  {if(clockElapsed(delayStart,ACCEL_SHAKE_MS)) accelerated=0;}
+
+constexpr fsmTransition accelTransitions[] PROGMEM=
+{
+  FSM_ROW(init_ACCEL,              wasCalibrated,        useStoredBases,     waitForStart_ACCEL),
+  FSM_ROW(init_ACCEL,              0,                    startSettle,        settle_ACCEL),
+  FSM_ROW(waitForStart_ACCEL,      shakeDetected,        reportShake,        delayForNextSense_ACCEL),
+  FSM_ROW(waitForStart_ACCEL,      0,                    clearAccelerated,   waitForStart_ACCEL),
+  FSM_ROW(delayForNextSense_ACCEL, senseDelayDone,       startRecalibration, recalibrate_ACCEL),
+  FSM_ROW(recalibrate_ACCEL,       recalibrateDelayDone, recalibrate,        waitForStart_ACCEL),
+  FSM_ROW(settle_ACCEL,            settled,              calibrate,          waitForStart_ACCEL),
+};
+constexpr fsmAction accelActions[] PROGMEM={0,0,endShake,0,0};
+#ifdef FSM_EXPORT
+const char* const accelNames[]={"init","waitForStart","delayForNextSense","recalibrate","settle"};
+#endif
+FSM_CHECK(accel);
+FSM_MACHINE(accel);
+
 void accelTick()
 {
-  static accel_ST state=init_ACCEL;
-  static int delayCounter;
-  static int calibrationMeasurement;
-  
-  switch(state)
-  {
-    case init_ACCEL:
-      accelerated=0;
-      delayCounter=0;
-      state=waitForStart_ACCEL;
-      break;
-    case waitForStart_ACCEL:
-      if(accel()ACCEL_THRESHOLD)
-      {
-        state=delayForNextSense_ACCEL;
-        accelerated=1;
-      }
-      else accelerated=0;
-      break;
-    case delayForNextSense_ACCEL:
-      //Because the tick function should 60 times a second, counting to
-      //320 gives a 5 second delay
-      if(delayCounter>300)
-      {
-        state=recalibrate_ACCEL;
-        delayCounter=0;
-        calibrationMeasurement=accel();
-      }
-      break;
-    case recalibrate_ACCEL:
-      if(delayCounter>120)
-      {
-        delayCounter=0;
-        int currentAccel=accel();
-        if(calibrationMeasurement-currentAccel<200 & calibrationMeasurement-currentAccel>0) calibrate();
-        else if(calibrationMeasurement-currentAccel>-200 & calibrationMeasurement-currentAccel<0) calibrate();
-        state=waitForStart_ACCEL;
-        
-      }
-      break;
-    default:
-      break;
-  }
-  switch(state)
-  {
-    case init_ACCEL:
-      break;
-    case waitForStart_ACCEL:
-      break;
-    case delayForNextSense_ACCEL:
-      if(delayCounter>=7) accelerated=0;
-      delayCounter++;
-      break;
-    case recalibrate_ACCEL:
-      delayCounter++;
-      break;
-    default:
-      break;
-  }
+  static unsigned char state=init_ACCEL;
+  state=fsmStep(&accelMachine,state);
 }
-
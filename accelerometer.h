@@ -1,8 +1,49 @@
+//The sensor profiles, which set the sensor's own low pass filter and
+//sample rate.  ACCEL_PROFILE picks one.  All keep the ranges at +/-2g and
+//+/-250 degrees per second, which the posture filter expects
+#define ACCEL_PROFILE_TICK 0    //One sample per tick, filtered to 21Hz
+#define ACCEL_PROFILE_SMOOTH 1  //One sample per tick, filtered to 10Hz
+#define ACCEL_PROFILE_RAW 2     //The power on settings, unfiltered
+#ifndef ACCEL_PROFILE
+#define ACCEL_PROFILE ACCEL_PROFILE_TICK
+#endif
+
+//A g in the sensor's units, at the +/-2g range
+#define ACCEL_G 16384
+
+//The defaults for the acceleration that counts as a shake, in the sensor's
+//units, and how long to wait after a shake before measuring again (in
+//milliseconds).  Once calibrated, lying still reads near 0, and turning
+//over slowly up to 2g, as gravity turns round, so a shake must pass
+//that.  A hard shake reaches about 3g.  The values in use are kept in the
+//settings (see settings.h)
+#define ACCEL_THRESHOLD (5*ACCEL_G/2)
+#define ACCEL_SENSE_DELAY_MS 5000
+
+//The change in acceleration that wakes the robot from standby, in the
+//sensor's units of 2mg (20 is a twentieth of a g), and how often the
+//sensor looks for it while the robot sleeps (0 is 1.25 times a second,
+//1 is 5, 2 is 20 and 3 is 40).  Faster looks draw more current
+#define ACCEL_MOTION_THRESHOLD 20
+#define ACCEL_MOTION_RATE 0
+
 //Prepare the accelerometer for use
 void setUpAccel();
 
-//Read the acceleration, calibrated to remove
-//the pull of gravity measured during setUpAccel
+//Stops reading the axes, and leaves the sensor asleep but for its
+//accelerometer, which it wakes now and then to look for motion.  Motion
+//pulls its INT pin low until accelWake().  This waits for the bus
+void accelSleep();
+
+//Wakes the sensor after accelSleep(), and configures it again as
+//setUpAccel() does, leaving the bus manager to do it on the next ticks
+void accelWake();
+
+//Returns 1 once the sensor has read back the profile setUpAccel() queued
+int accelConfigured();
+
+//Read the magnitude of the acceleration, in the sensor's units (ACCEL_G
+//to a g), less the pull of gravity measured when it was calibrated
 unsigned int accel();
 
 //Advance the state machine one tick.
@@ -0,0 +1,161 @@
+/**This library scans several analog inputs with the ADC.  Conversions are
+ * started one at a time by the conversion complete interrupt, which also
+ * switches the multiplexer.  Because the next conversion is only started
+ * after the multiplexer has been changed, no reading ever mixes channels.
+ */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "analog.h"
+#include "thermometer.h"
+
+/**The channel list.  The thermometer keeps its ADC1 input, unless it
+ * is read from the IMU instead (THERM_IMU).  The battery
+ * is read through a divider on ADC2, the light sensor on ADC3, and the
+ * microphone module's level output on ADC0.  The supply voltage is found
+ * from the internal bandgap, which needs no pin.  The envelope of the
+ * soundFX board's output is read on ADC6 for the lip sync.  Temperature
+ * and battery voltage change slowly, so they are read less often.
+ *
+ * A pass of the scan takes about 50ms, too slow for the lip sync, so the
+ * speaker is read once after each of the other slots instead of once a
+ * pass.  The longest gap is then the 16 conversions of one oversampled
+ * slot, about 27ms, and most are a few milliseconds.
+ */
+const analogChannel analogChannels[ANALOG_CHANNELS] PROGMEM=
+{
+#ifndef THERM_IMU
+  {1,THERM_EXTRA_BITS,1,thermSample},  //ANALOG_TEMPERATURE
+#endif
+  {2,2,4,0},                           //ANALOG_BATTERY
+  {3,1,2,0},                           //ANALOG_LIGHT
+  {0,0,1,0},                           //ANALOG_MIC
+  {14,2,2,0},                          //ANALOG_SUPPLY
+#ifdef ANALOG_SPEAKER
+  {6,0,1,0},                           //ANALOG_SPEAKER
+#endif
+};
+
+//The slots read round-robin, which leaves out the speaker
+#ifdef ANALOG_SPEAKER
+#define ANALOG_SCANNED ANALOG_SPEAKER
+#else
+#define ANALOG_SCANNED ANALOG_CHANNELS
+#endif
+
+static unsigned int analogBack[ANALOG_CHANNELS];
+static unsigned int analogFront[ANALOG_CHANNELS];
+//One bit per slot whose back buffer entry is newer than the front
+static volatile unsigned char analogFresh;
+
+//The slot being converted, the slot the scan returns to after the
+//speaker, and the progress of the oversampling
+static unsigned char slot;
+static unsigned char scanned;
+static unsigned int sum;
+static unsigned char count;
+//Passes of the scan left before each slot is read again
+static unsigned char skip[ANALOG_CHANNELS];
+
+static unsigned char channelMux(unsigned char i)
+  {return pgm_read_byte(&analogChannels[i].mux);}
+
+/**Selects a channel while keeping the AVcc reference
+ */
+static void selectChannel(unsigned char i)
+  {ADMUX=(1<<REFS0)|channelMux(i);}
+
+/**Configure the ADC and begin the first conversion of the scan
+ */
+void setUpAnalog()
+{
+  //Make every scanned pin an input, and turn off its digital input
+  //buffer, which otherwise wastes power on an analog voltage
+  for(unsigned char i=0;i<ANALOG_CHANNELS;i++)
+  {
+    unsigned char mux=channelMux(i);
+    if(mux<6)
+    {
+      DDRC&=~(1<<mux);
+      DIDR0|=1<<mux;
+    }
+    skip[i]=1;
+  }
+  //A scan cut off by analogSleep() may have left a reading half summed
+  slot=0;
+  scanned=0;
+  sum=0;
+  count=0;
+  selectChannel(0);
+  //Enable the ADC with the /128 prescaler, single conversions, and the
+  //conversion complete interrupt, then begin measuring
+  ADCSRA=(1<<ADEN)|(1<<ADIE)|(1<<ADPS2)|(1<<ADPS1)|(1<<ADPS0);
+  ADCSRA|=(1<<ADSC);
+}
+
+/**Turning the ADC off abandons the conversion under way.  Its flag is
+ * cleared too, so the interrupt doesn't run for it
+ */
+void analogSleep()
+  {ADCSRA=(1<<ADIF);}
+
+/**Moves to the next slot that is due to be read this pass, by way of
+ * the speaker
+ */
+static void nextSlot()
+{
+#ifdef ANALOG_SPEAKER
+  if(slot!=ANALOG_SPEAKER)
+  {
+    scanned=slot;
+    slot=ANALOG_SPEAKER;
+    return;
+  }
+#endif
+  slot=scanned;
+  do
+  {
+    if(++slot>=ANALOG_SCANNED) slot=0;
+  } while(--skip[slot]);
+  skip[slot]=pgm_read_byte(&analogChannels[slot].divisor);
+}
+
+ISR(ADC_vect)
+{
+  unsigned char extraBits=pgm_read_byte(&analogChannels[slot].extraBits);
+  sum+=ADC;
+  if(++count>=(1<<(2*extraBits)))
+  {
+    unsigned int reading=sum>>extraBits;
+    analogBack[slot]=reading;
+    analogFresh|=1<<slot;
+    void (*onSample)(unsigned int)=(void (*)(unsigned int))pgm_read_word(&analogChannels[slot].onSample);
+    if(onSample) onSample(reading);
+    sum=0;
+    count=0;
+    nextSlot();
+    selectChannel(slot);
+  }
+  ADCSRA|=(1<<ADSC);
+}
+
+/**Copies finished readings to the front buffer.  Interrupts are held off
+ * only for the copy, so a conversion that finishes meanwhile is delayed by
+ * a few microseconds at most, never lost.
+ */
+void analogLatch()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    unsigned char fresh=analogFresh;
+    for(unsigned char i=0;i<ANALOG_CHANNELS;i++)
+      if(fresh&(1<<i)) analogFront[i]=analogBack[i];
+    analogFresh=0;
+  }
+}
+
+/**Returns the latched reading of slot i
+ */
+unsigned int analogRead(unsigned char i)
+  {return analogFront[i];}
@@ -0,0 +1,67 @@
+#ifndef analog_h
+#define analog_h
+/**This library scans several analog inputs with the ADC.  The conversion
+ * complete interrupt walks round-robin over the channel list in analog.cpp,
+ * oversampling each channel and starting the next conversion itself, so the
+ * main loop never starts or waits for a conversion.  Readings are double
+ * buffered: the interrupt fills a back buffer, and analogLatch() copies the
+ * finished readings to the front buffer that analogRead() returns.
+ */
+
+//Slots in the channel list.  The order must match analogChannels[].
+//With THERM_IMU the temperature comes from the IMU, so it has no slot.
+//With VOICE_PCM the lip sync follows the decoded audio, so the speaker
+//has no slot either.  Otherwise it is last, and read between every two
+//of the other slots
+#ifdef THERM_IMU
+#define ANALOG_BATTERY 0
+#else
+#define ANALOG_TEMPERATURE 0
+#define ANALOG_BATTERY 1
+#endif
+#define ANALOG_LIGHT (ANALOG_BATTERY+1)
+#define ANALOG_MIC (ANALOG_BATTERY+2)
+#define ANALOG_SUPPLY (ANALOG_BATTERY+3)
+#ifdef VOICE_PCM
+#define ANALOG_CHANNELS (ANALOG_BATTERY+4)
+#else
+#define ANALOG_SPEAKER (ANALOG_BATTERY+4)
+#define ANALOG_CHANNELS (ANALOG_BATTERY+5)
+#endif
+
+//ANALOG_SUPPLY measures the internal 1.1V bandgap against AVcc, so its
+//reading rises as the supply falls.  This gives the reading (with 2 extra
+//bits) that corresponds to a supply of mv millivolts
+#define SUPPLY_READING(mv) (1100UL*4096/(mv))
+
+struct analogChannel
+{
+  //ADMUX channel selection bits (0-7 for the pins ADC0-ADC7, 14 for
+  //the internal bandgap reference)
+  unsigned char mux;
+  //Each reading sums 4^extraBits conversions and shifts by extraBits,
+  //so it is 10+extraBits bits wide
+  unsigned char extraBits;
+  //The channel is only read on every divisor'th pass of the scan, so
+  //slow signals don't take conversions from fast ones
+  unsigned char divisor;
+  //Called from the interrupt with every new reading (may be 0)
+  void (*onSample)(unsigned int);
+};
+
+//Configure the ADC and start scanning the channel list
+void setUpAnalog();
+
+//Stop the scan and turn the ADC off, which it must be to save power in
+//sleep.  setUpAnalog() starts the scan again
+void analogSleep();
+
+//Copy the readings finished since the last call to the front buffer.
+//Call this once at the start of each tick so every reading made during
+//the tick comes from the same snapshot
+void analogLatch();
+
+//Returns the latched reading of a slot
+unsigned int analogRead(unsigned char slot);
+
+#endif
@@ -0,0 +1,161 @@
+/**This library streams named blobs from the SPI flash through a small
+ * cache.  A line is "pinned" while a stream is reading it, so fetching
+ * the next line never replaces data a stream is still using, and the
+ * fast path of assetByte() is just a count and a pointer increment.
+ */
+#include <string.h>
+#include "assets.h"
+#include "spiflash.h"
+
+#define DIRECTORY_HEADER 8
+#define DIRECTORY_ENTRY 16
+
+enum line_ST {empty_LINE,loading_LINE,ready_LINE};
+struct cacheLine
+{
+  unsigned long address;
+  volatile unsigned char state;
+  unsigned char pinned;
+  unsigned char data[ASSET_LINE_LENGTH];
+};
+
+static cacheLine cache[ASSET_LINES];
+static unsigned int entries;
+static unsigned char nameHash[ASSET_INDEX];
+
+/**Reads a little endian number from a buffer
+ */
+static unsigned long littleEndian(const unsigned char* bytes, unsigned char n)
+{
+  unsigned long value=0;
+  while(n--) value=(value<<8)|bytes[n];
+  return value;
+}
+
+/**Hashes a name as it is stored, padded with zeros to ASSET_NAME_LENGTH
+ */
+static unsigned char hashName(const char* name)
+{
+  unsigned char hash=0;
+  for(unsigned char i=0;i<ASSET_NAME_LENGTH && name[i];i++)
+    hash=((hash<<1)|(hash>>7))^name[i];
+  return hash;
+}
+
+static void readEntry(unsigned int i, unsigned char* entry)
+  {spiFlashRead(DIRECTORY_HEADER+(unsigned long)i*DIRECTORY_ENTRY,entry,DIRECTORY_ENTRY);}
+
+/**Reads the header, then every indexed entry once for its hash
+ */
+void setUpAssets()
+{
+  unsigned char header[DIRECTORY_HEADER];
+  setUpSpiFlash();
+  spiFlashRead(0,header,DIRECTORY_HEADER);
+  if(memcmp(header,"MMAS",4)) entries=0;
+  else entries=littleEndian(header+4,2);
+
+  unsigned char entry[DIRECTORY_ENTRY];
+  for(unsigned int i=0;i<entries && i<ASSET_INDEX;i++)
+  {
+    readEntry(i,entry);
+    nameHash[i]=hashName((const char*)entry);
+  }
+}
+
+unsigned int assetCount()
+  {return entries;}
+
+int openAsset(const char* name, assetStream* stream)
+{
+  unsigned char hash=hashName(name);
+  unsigned char entry[DIRECTORY_ENTRY];
+  for(unsigned int i=0;i<entries;i++)
+  {
+    if(i<ASSET_INDEX && nameHash[i]!=hash) continue;
+    readEntry(i,entry);
+    if(strncmp((const char*)entry,name,ASSET_NAME_LENGTH)) continue;
+    stream->start=littleEndian(entry+8,4);
+    stream->length=littleEndian(entry+12,4);
+    stream->position=0;
+    stream->left=0;
+    stream->line=-1;
+    return 1;
+  }
+  return 0;
+}
+
+/**Returns the line holding the flash address base, or -1
+ */
+static signed char findLine(unsigned long base)
+{
+  for(signed char i=0;i<ASSET_LINES;i++)
+    if(cache[i].state!=empty_LINE && cache[i].address==base) return i;
+  return -1;
+}
+
+/**Starts fetching the line at base into an unpinned line, unless it is
+ * already cached or the flash is busy (the fetch is then retried the next
+ * time the line is wanted)
+ */
+static void fetch(unsigned long base)
+{
+  //The line being loaded has arrived once the flash is free again
+  for(signed char i=0;i<ASSET_LINES;i++)
+    if(cache[i].state==loading_LINE && !spiFlashBusy()) cache[i].state=ready_LINE;
+
+  if(findLine(base)>=0 || spiFlashBusy()) return;
+  for(signed char i=0;i<ASSET_LINES;i++)
+  {
+    if(cache[i].pinned) continue;
+    cache[i].address=base;
+    cache[i].state=loading_LINE;
+    if(!spiFlashReadAsync(base,cache[i].data,ASSET_LINE_LENGTH)) cache[i].state=empty_LINE;
+    else if(!spiFlashBusy()) cache[i].state=ready_LINE;
+    return;
+  }
+}
+
+void closeAsset(assetStream* stream)
+{
+  if(stream->line>=0) cache[stream->line].pinned=0;
+  stream->line=-1;
+  stream->left=0;
+}
+
+/**Moves the stream onto the line holding its position.  Returns 0 if
+ * that line hasn't arrived yet, or the stream has ended
+ */
+static int nextLine(assetStream* stream)
+{
+  closeAsset(stream);
+  if(assetEnd(stream)) return 0;
+
+  unsigned long address=stream->start+stream->position;
+  unsigned long base=address&~(unsigned long)(ASSET_LINE_LENGTH-1);
+  fetch(base);
+  signed char i=findLine(base);
+  if(i<0 || cache[i].state!=ready_LINE) return 0;
+
+  cache[i].pinned=1;
+  stream->line=i;
+  unsigned char offset=address-base;
+  stream->data=cache[i].data+offset;
+  stream->left=ASSET_LINE_LENGTH-offset;
+  if(stream->length-stream->position<stream->left) stream->left=stream->length-stream->position;
+
+  //Fetch the next line while this one is read
+  if(address-offset+ASSET_LINE_LENGTH<stream->start+stream->length) fetch(base+ASSET_LINE_LENGTH);
+  return 1;
+}
+
+int assetByte(assetStream* stream)
+{
+  if(!stream->left && !nextLine(stream)) return -1;
+  stream->left--;
+  stream->position++;
+  return *stream->data++;
+}
+
+int assetEnd(const assetStream* stream)
+  {return stream->position>=stream->length;}
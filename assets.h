@@ -0,0 +1,64 @@
+#ifndef assets_h
+#define assets_h
+/**This library finds named blobs (audio clips, animations) in the SPI
+ * flash and streams them through a small RAM cache.  The flash begins
+ * with a directory, written by tools/mkassets.py:
+ *
+ *   "MMAS", the number of entries (2 bytes), 2 reserved bytes, then for
+ *   each entry an 8 byte name padded with zeros, the blob's address and
+ *   its length (4 bytes each).  All numbers are little endian.
+ *
+ * Streams are read a byte at a time and never wait for the flash.  When a
+ * stream starts on a cache line, the next line is fetched in the background,
+ * so a stream read steadily (at audio rates, say) always finds its data
+ * waiting.  The fetches start the SPI bus, so streams are only read from the
+ * main loop, never from an interrupt.
+ */
+
+#define ASSET_NAME_LENGTH 8
+
+//setUpAssets() keeps a one byte hash of the first ASSET_INDEX names, so
+//opening a blob reads only the entries whose hash matches.  Entries past
+//these are read one by one
+#define ASSET_INDEX 64
+
+//The cache holds ASSET_LINES lines of ASSET_LINE_LENGTH bytes (a power of 2).
+//Every stream being read holds one line, so there must be at least one
+//more line than streams read at the same time
+#define ASSET_LINE_LENGTH 64
+#define ASSET_LINES 2
+
+struct assetStream
+{
+  //Where the blob is in the flash, and its length
+  unsigned long start;
+  unsigned long length;
+  //How far the stream has been read
+  unsigned long position;
+  //The next byte, and how many are left, in the line being read
+  const unsigned char* data;
+  unsigned char left;
+  signed char line;
+};
+
+//Configure the flash and index the directory
+void setUpAssets();
+
+//Returns the number of blobs in the directory (0 if there is no directory)
+unsigned int assetCount();
+
+//Opens the blob called name as a stream.  Returns 1 if it was found, 0
+//otherwise.  This waits for the flash to read the matching entry
+int openAsset(const char* name, assetStream* stream);
+
+//Releases the stream's cache line
+void closeAsset(assetStream* stream);
+
+//Returns the next byte of the stream, or -1 if it isn't in the cache yet
+//(it is being fetched) or the stream has ended.  Call from the main loop
+int assetByte(assetStream* stream);
+
+//Returns 1 once every byte of the stream has been read
+int assetEnd(const assetStream* stream);
+
+#endif
@@ -0,0 +1,202 @@
+/**This library plays 4-bit IMA ADPCM clips from flash.  The main loop
+ * decodes ahead into a ring of PWM levels once a tick, and the overflow
+ * interrupt only moves the next level to OCR0B, so the output is updated
+ * at the same point of every sample period and the interrupt stays short
+ * enough for the sample rate.  The ring holds two ticks of samples, so a
+ * late tick, or a stream from the asset store whose next cache line is
+ * late, is covered without an underrun.
+ */
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "audio.h"
+#include "clips.h"
+
+//The IMA ADPCM quantizer step sizes
+static const unsigned int stepTable[89] PROGMEM=
+{
+  7,8,9,10,11,12,13,14,16,17,19,21,23,25,28,31,34,37,41,45,50,55,60,66,73,
+  80,88,97,107,118,130,143,157,173,190,209,230,253,279,307,337,371,408,449,
+  494,544,598,658,724,796,876,963,1060,1166,1282,1411,1552,1707,1878,2066,
+  2272,2499,2749,3024,3327,3660,4026,4428,4871,5358,5894,6484,7132,7845,8630,
+  9493,10442,11487,12635,13899,15289,16818,18500,20350,22385,24623,27086,
+  29794,32767
+};
+
+//How the step index moves after each code (the sign bit is ignored)
+static const signed char indexTable[8] PROGMEM={-1,-1,-1,-1,2,4,6,8};
+
+//The clip being decoded, from flash or from the asset store
+static const unsigned char* clipData;
+static unsigned int clipLeft;
+#ifdef ASSET_STORE
+static assetStream stream;
+static unsigned char streaming;
+#endif
+static int predictor;
+static unsigned char stepIndex;
+
+unsigned char audioRing[AUDIO_RING];
+volatile unsigned char audioHead;
+volatile unsigned char audioTail;
+
+static unsigned char playing;
+static unsigned char peak;
+static unsigned char volume=0xFF;
+
+//How far the volume scaled sample is shifted down to swing by
+//AUDIO_SILENCE; the level is clamped to TOP on the extremes
+#if AUDIO_SILENCE>=100
+#define LEVEL_SHIFT 8
+#else
+#define LEVEL_SHIFT 9
+#endif
+
+/**Enables output B at the silence level, so starting the output
+ * doesn't make a click
+ */
+void setUpAudio()
+{
+  OCR0B=AUDIO_SILENCE;
+  TCCR0A|=(1<<COM0B1);
+  DDRD|=0x20;
+}
+
+void audioPlay(unsigned char n)
+{
+  if(n>=AUDIO_CLIPS) return;
+  audioStop();
+  clipData=(const unsigned char*)pgm_read_word(&audioClips[n].data);
+  clipLeft=pgm_read_word(&audioClips[n].length);
+  predictor=0;
+  stepIndex=0;
+  playing=1;
+}
+
+#ifdef ASSET_STORE
+void audioPlayAsset(const assetStream* s)
+{
+  audioStop();
+  stream=*s;
+  streaming=1;
+  predictor=0;
+  stepIndex=0;
+  playing=1;
+}
+#endif
+
+/**Empties the ring with the interrupt held off, as it may move the
+ * tail between reading it and setting the head
+ */
+void audioStop()
+{
+  clipLeft=0;
+#ifdef ASSET_STORE
+  if(streaming) closeAsset(&stream);
+  streaming=0;
+#endif
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    audioHead=audioTail;
+  }
+  OCR0B=AUDIO_SILENCE;
+  playing=0;
+}
+
+int audioPlaying()
+  {return playing;}
+
+void audioSetVolume(unsigned char v)
+  {volume=v;}
+
+unsigned char audioPeak()
+{
+  unsigned char p=peak;
+  peak=0;
+  return p;
+}
+
+/**Decodes one 4-bit code and returns it as a PWM level
+ */
+static unsigned char decode(unsigned char code)
+{
+  unsigned int step=pgm_read_word(&stepTable[stepIndex]);
+  unsigned int diff=step>>3;
+  if(code&4) diff+=step;
+  if(code&2) diff+=step>>1;
+  if(code&1) diff+=step>>2;
+
+  //Clamp in 16 bits by comparing the step with the room left
+  unsigned int p=predictor;
+  if(code&8) predictor=diff>p+32768u?-32768:(int)(p-diff);
+  else predictor=diff>32767u-p?32767:(int)(p+diff);
+
+  signed char index=stepIndex+(signed char)pgm_read_byte(&indexTable[code&7]);
+  if(index<0) index=0;
+  else if(index>88) index=88;
+  stepIndex=index;
+
+  //Scale the top 8 bits by the volume; the largest swing is half of TOP
+  int level=AUDIO_SILENCE+(((signed char)(predictor>>8)*volume)>>LEVEL_SHIFT);
+  if(level<0) level=0;
+  else if(level>(int)AUDIO_TOP) level=AUDIO_TOP;
+  return level;
+}
+
+/**Returns the next byte of the clip, or -1 if there is none yet
+ */
+static int nextCodes()
+{
+#ifdef ASSET_STORE
+  if(streaming) return assetByte(&stream);
+#endif
+  if(!clipLeft) return -1;
+  clipLeft--;
+  return pgm_read_byte(clipData++);
+}
+
+/**Returns 1 once every byte of the clip has been decoded
+ */
+static int clipEnded()
+{
+#ifdef ASSET_STORE
+  if(streaming)
+  {
+    if(!assetEnd(&stream)) return 0;
+    closeAsset(&stream);
+    streaming=0;
+  }
+#endif
+  return !clipLeft;
+}
+
+/**Adds a level at the head of the ring, and tracks the peak for the
+ * envelope follower
+ */
+static void put(unsigned char level)
+{
+  unsigned char head=audioHead;
+  audioRing[head]=level;
+  audioHead=head+1;
+  unsigned char swing=level>AUDIO_SILENCE?level-AUDIO_SILENCE:AUDIO_SILENCE-level;
+  if(swing>peak) peak=swing;
+}
+
+void audioFill()
+{
+  if(!playing) return;
+  //Decode while both samples of the next byte fit in the ring, which
+  //keeps one place free so a full ring isn't taken for an empty one
+  while((unsigned char)(audioTail-audioHead-1)>=2)
+  {
+    int codes=nextCodes();
+    if(codes<0) break;
+    put(decode(codes&0x0F));
+    put(decode(codes>>4));
+  }
+  if(audioHead==audioTail && clipEnded())
+  {
+    OCR0B=AUDIO_SILENCE;
+    playing=0;
+  }
+}
@@ -0,0 +1,110 @@
+#ifndef audio_h
+#define audio_h
+/**This library plays 4-bit IMA ADPCM clips stored in flash through Timer 0's
+ * output B (pin D5), so no sound board is needed.  Timer 0 runs in fast PWM
+ * mode with its period set to one sample, and its overflow interrupt calls
+ * audioSample().  D5 needs an RC low pass filter in front of the amplifier
+ * to remove the PWM carrier.
+ */
+#include <avr/io.h>
+
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
+
+//The rate the clips are recorded and played at (see tools/adpcm.py)
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE 8000
+#endif
+
+//Timer 0's prescaler and TOP, which make it overflow once per sample.  The
+//prescaler is only used when the clock is too fast to count a sample in 8 bits
+#if F_CPU/AUDIO_SAMPLE_RATE<=256
+#define AUDIO_PRESCALER 1
+#else
+#define AUDIO_PRESCALER 8
+#endif
+#define AUDIO_TOP (F_CPU/AUDIO_PRESCALER/AUDIO_SAMPLE_RATE-1)
+#if AUDIO_TOP>255
+#error "Timer 0 can't count a sample period this long; raise AUDIO_SAMPLE_RATE"
+#endif
+
+//The PWM level of silence, halfway between 0 and TOP
+#define AUDIO_SILENCE (AUDIO_TOP/2)
+
+//Estimates of the cycles each sample costs: the overflow interrupt with
+//its entry and return, and the millisecond clock it keeps every eighth
+//time averaged in, and decoding in the main loop, with the fetch and the
+//loop shared by two samples.  They are not measured; until tools/bench.py
+//has been run for audioSample and audioFill, treat the budget check below
+//as a rough guide and replace these with the figures it reports
+#define AUDIO_ISR_CYCLES 79
+#define AUDIO_DECODE_CYCLES 185
+
+//The most of the CPU the audio may take, in percent.  The ticks, the
+//servos and the other interrupts need the rest.  It is only checked when
+//the firmware plays through Timer 0, which needs more than the 1MHz clock
+#define AUDIO_CPU_PERCENT 50
+#if defined(VOICE_PCM) && (AUDIO_ISR_CYCLES+AUDIO_DECODE_CYCLES)*100UL>AUDIO_CPU_PERCENT*(F_CPU/AUDIO_SAMPLE_RATE)
+#error "The audio needs more of the CPU than AUDIO_CPU_PERCENT; raise F_CPU or lower AUDIO_SAMPLE_RATE"
+#endif
+
+//The ring of decoded PWM levels.  audioFill() adds at the head from the
+//main loop and audioSample() takes from the tail in the interrupt, so the
+//8 bit indices need no locking and wrap round the ring by themselves.  It
+//holds 32ms at 8kHz, enough to cover a tick and a late one
+#define AUDIO_RING 256
+extern unsigned char audioRing[AUDIO_RING];
+extern volatile unsigned char audioHead;
+extern volatile unsigned char audioTail;
+
+struct audioClip
+{
+  //The ADPCM data in flash, two samples per byte, low nibble first
+  const unsigned char* data;
+  //The length of the data in bytes
+  unsigned int length;
+};
+
+//Enable the PWM output at the silence level.  Timer 0 itself is set up
+//by interruptSetUp()
+void setUpAudio();
+
+//Start playing clip n from the beginning, replacing any clip playing
+void audioPlay(unsigned char n);
+
+#ifdef ASSET_STORE
+#include "assets.h"
+//Start playing an ADPCM blob from the asset store.  The engine takes its
+//own copy of the stream, and closes it when the blob ends
+void audioPlayAsset(const assetStream* stream);
+#endif
+
+//Stop playing
+void audioStop();
+
+//Returns 1 while a clip is playing, 0 otherwise
+int audioPlaying();
+
+//Sets the volume (0-255)
+void audioSetVolume(unsigned char volume);
+
+//Returns the largest swing away from silence decoded since the last
+//call (0-AUDIO_SILENCE), for following the envelope
+unsigned char audioPeak();
+
+//Decodes until the ring is full.  Call once per tick
+void audioFill();
+
+//Outputs the next sample.  Called by Timer 0's overflow interrupt once per
+//sample.  It is inline so the interrupt saves no more registers than it
+//uses.  If the ring runs dry the last level is held
+static inline void audioSample()
+{
+  unsigned char tail=audioTail;
+  if(tail==audioHead) return;
+  OCR0B=audioRing[tail];
+  audioTail=tail+1;
+}
+
+#endif
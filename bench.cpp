@@ -0,0 +1,180 @@
+/**This library times code with Timer 1 running freely from the CPU clock,
+ * so each count is one cycle.  A 16 bit count holds any piece of code
+ * shorter than 65ms at 1MHz; anything longer is reported as 65535.  The
+ * cost of starting and stopping the timer is measured first and taken off
+ * every result.
+ */
+#ifdef BENCH
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include "bench.h"
+#include "servo.h"
+#include "accelerometer.h"
+#include "i2cbus.h"
+#include "posture.h"
+#include "control.h"
+#include "voice.h"
+#include "lipsync.h"
+#include "thermometer.h"
+#include "analog.h"
+#include "stackcheck.h"
+#ifdef VOICE_PCM
+#include "audio.h"
+#endif
+
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
+
+//Kernels that aren't in any header
+unsigned int mySqrt(unsigned long in);
+int roundIntDivision(int dividend, int divisor);
+
+//From mickeyMouse.ino
+void mySetup();
+void myLoop();
+extern volatile unsigned char ticksDue;
+
+static unsigned int overhead;
+
+static void startTimer()
+{
+  TCCR1B=0;
+  TCNT1=0;
+  TIFR1=(1<<TOV1);
+  TCCR1B=(1<<CS10);
+}
+
+static unsigned int stopTimer()
+{
+  TCCR1B=0;
+  if(TIFR1&(1<<TOV1)) return 0xFFFF;
+  unsigned int cycles=TCNT1;
+  return cycles>overhead?cycles-overhead:0;
+}
+
+static void put(char c)
+{
+  while(!(UCSR0A&(1<<UDRE0)));
+  UDR0=c;
+}
+
+static void putString(const char* s)
+  {while(char c=pgm_read_byte(s++)) put(c);}
+
+static void putNumber(unsigned int n)
+{
+  char digits[5];
+  unsigned char i=0;
+  do digits[i++]='0'+n%10; while(n/=10);
+  while(i) put(digits[--i]);
+}
+
+static void report(const char* name, unsigned int least, unsigned int most, unsigned long total)
+{
+  putString(PSTR("BENCH "));
+  putString(name);
+  put(' ');
+  putNumber(least);
+  put(' ');
+  putNumber(most);
+  put(' ');
+  putNumber(total/BENCH_RUNS);
+  put('\n');
+}
+
+/**Times the code BENCH_RUNS times and reports it as "name"
+ */
+#define BENCH_TIME(name,...) \
+  do { \
+    unsigned int least=0xFFFF,most=0; \
+    unsigned long total=0; \
+    for(unsigned char run=0;run<BENCH_RUNS;run++) \
+    { \
+      startTimer(); \
+      __VA_ARGS__; \
+      unsigned int cycles=stopTimer(); \
+      if(cycles<least) least=cycles; \
+      if(cycles>most) most=cycles; \
+      total+=cycles; \
+    } \
+    report(PSTR(name),least,most,total); \
+  } while(0)
+
+//Inputs the compiler can't fold, and a place for results it would
+//otherwise throw away
+static volatile unsigned long square=0x12345UL;
+static volatile int axisX=1200;
+static volatile int axisY=-300;
+static volatile int axisZ=16000;
+static volatile unsigned int sink;
+
+void benchMain()
+{
+  mySetup();
+
+  //Only the interrupts the measured code waits on (the I2C and the UART)
+  //are left on, so nothing else is counted against it
+  TIMSK0=0;
+  TIMSK1=0;
+  ADCSRA&=~(1<<ADIE);
+  TCCR1A=0;
+
+  //Let the voice finish sending, then take over the UART
+  while(UCSR0B&(1<<UDRIE0));
+  UCSR0A=(1<<U2X0);
+  UBRR0=(F_CPU/(8UL*BENCH_BAUD))-1;
+  UCSR0C=(1<<UCSZ01)|(1<<UCSZ00);
+  UCSR0B=(1<<TXEN0);
+
+  startTimer();
+  overhead=stopTimer();
+
+  BENCH_TIME("mySqrt",sink=mySqrt(square));
+  //The arithmetic of accel(), on fixed axes
+  BENCH_TIME("magnitude",{signed int x=axisX,y=axisY,z=axisZ;
+    unsigned long sum=(unsigned long)((long)x*x);
+    sum+=(unsigned long)((long)y*y);
+    sum+=(unsigned long)((long)z*z);
+    sink=mySqrt(sum);});
+  BENCH_TIME("accel",sink=accel());
+  BENCH_TIME("postureSample",postureSample(axisX>>8,axisY>>8,axisZ>>8,axisX,axisY));
+  BENCH_TIME("roundIntDivision",sink=roundIntDivision(axisX,6));
+  BENCH_TIME("setSpine",setSpine(100));
+  BENCH_TIME("setLeftShoulder",setLeftShoulder(100));
+  BENCH_TIME("setRightShoulder",setRightShoulder(100));
+  BENCH_TIME("analogLatch",analogLatch());
+  BENCH_TIME("i2cService",i2cService());
+  BENCH_TIME("accelTick",accelTick());
+  BENCH_TIME("controlTick",controlTick());
+  BENCH_TIME("voiceTick",voiceTick());
+  BENCH_TIME("lipSyncTick",lipSyncTick());
+  BENCH_TIME("thermTick",thermTick());
+  BENCH_TIME("servoTick",servoTick());
+#ifdef VOICE_PCM
+  //audioSample is the interrupt's body without its entry and return, and
+  //audioFill decodes a ring from empty, AUDIO_RING-2 samples
+  audioPlay(0);
+  audioFill();
+  BENCH_TIME("audioSample",audioSample());
+  BENCH_TIME("audioFill",{audioPlay(0);audioFill();});
+#endif
+  BENCH_TIME("myLoop",{ticksDue=1;myLoop();});
+
+  putString(PSTR("BENCH_DONE "));
+  putNumber(stackHighWater());
+  put('\n');
+  UCSR0A|=(1<<TXC0);
+  while(!(UCSR0A&(1<<TXC0)));
+
+  //Sleeping with interrupts off ends the simulation
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+}
+
+#endif
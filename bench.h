@@ -0,0 +1,22 @@
+#ifndef bench_h
+#define bench_h
+/**This library times the firmware's hot code in CPU cycles.  It is only
+ * built with BENCH defined, which replaces the main loop with benchMain().
+ * The code is meant to run under a cycle accurate simulator (see
+ * tools/bench.py), and each measurement is written to the UART as
+ *
+ *   BENCH <name> <min> <max> <mean>
+ *
+ * in cycles, followed by "BENCH_DONE <stack high water>" when all have run.
+ */
+
+//The number of times each piece of code is timed
+#define BENCH_RUNS 8
+
+//The UART speed of the report
+#define BENCH_BAUD 9600
+
+//Sets up the firmware, runs every benchmark, reports them, and stops
+void benchMain();
+
+#endif
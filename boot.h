@@ -0,0 +1,25 @@
+#ifndef boot_h
+#define boot_h
+/**This library times the start up.  Each phase is marked with bootMark()
+ * as it is reached, which keeps the microseconds since the clock started
+ * in bootTimes[], for a debugger or the simulation (see tools/sim.py) to
+ * read.  Only the first mark of each phase is kept.
+ */
+
+//The phases, in the order they are normally reached
+#define BOOT_CLOCK 0          //The clock has started
+#define BOOT_SERVOS 1         //The servos are driving to their home positions
+#define BOOT_IMU 2            //The IMU's set up is queued on the bus
+#define BOOT_PERIPHERALS 3    //The ADC, button, voice and asset store are set up
+#define BOOT_READY 4          //Setup has finished and the loop starts
+#define BOOT_FIRST_SAMPLE 5   //The first reading from the IMU has arrived
+#define BOOT_CALIBRATED 6     //The accelerometer has its gravitational offsets
+#define BOOT_PHASES 7
+
+extern unsigned long bootTimes[BOOT_PHASES];
+
+//Records the time a phase was reached.  Defined next to the clock's
+//interrupt in mickeyMouse.ino
+void bootMark(unsigned char phase);
+
+#endif
@@ -1,9 +1,13 @@
 /**This library implements a button.  It is set up so that the button
  * should be connected to port D4.  The input pin will be high when the
- * button is disconnected, so the button should connect the pin to ground
+ * button is disconnected, so the button should connect the pin to ground.
+ * Presses are posted to the event queue from the pin change interrupt.
  */
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include "button.h"
+#include "events.h"
+#include "clock.h"
 
 /**This function prepares the button for use by configureing the port
  */
@@ -13,6 +17,9 @@ void setUpButton()
   DDRD &= 0xEF;
   //This enables the internal pull up resistor on the port.
   PORTD |= 0x10;
+  //Interrupt when D4 (PCINT20) changes
+  PCMSK2 |= (1<<PCINT20);
+  PCICR |= (1<<PCIE2);
 }
 
 /**This returns 0 if the button is unpressed and true if pressed
@@ -21,54 +28,20 @@ int button()
   {return !(PIND & 0x10);}
   
 
-int pressed;
-
-int pressing(){return pressed;}
+/**The pin change interrupt posts a press as soon as it happens.  A press
+ * within BUTTON_HOLDOFF_MS of the last one posted is bounce, or the
+ * same press, so it is ignored.  The full 32 bit clock is compared, so a
+ * press never falls inside a holdoff wrapped round from long ago.
+ */
+static unsigned long lastPress;
+static unsigned char pressedOnce;
 
-enum button_ST {init_BUTTON,waitForStart_BUTTON,delayForNextSense_BUTTON};
-void buttonTick()
+ISR(PCINT2_vect)
 {
-  static button_ST state=init_BUTTON;
-  static int delayCounter;
-  switch(state)
-  {
-    case init_BUTTON:
-      pressed=0;
-      delayCounter=0;
-      state=waitForStart_BUTTON;
-      break;
-    case waitForStart_BUTTON:
-      if(button()>0)
-      {
-        state=delayForNextSense_BUTTON;
-        pressed=1;
-      }
-      else pressed=0;
-      break;
-    case delayForNextSense_BUTTON:
-      //Because the tick function should 60 times a second, counting to
-      //160 gives a 2.5 second delay
-      if(delayCounter>160)
-      {
-        state=waitForStart_BUTTON;
-        delayCounter=0;
-      }
-      break;
-    default:
-      break;
-  }
-  switch(state)
-  {
-    case init_BUTTON:
-      break;
-    case waitForStart_BUTTON:
-      break;
-    case delayForNextSense_BUTTON:
-      delayCounter++;
-      break;
-    default:
-      break;
-  }
+  if(!button()) return;
+  unsigned long time=clockMs;
+  if(pressedOnce && time-lastPress<BUTTON_HOLDOFF_MS) return;
+  pressedOnce=1;
+  lastPress=time;
+  postEvent(&isrEvents,BUTTON_EVENT,0);
 }
-
-
@@ -1,18 +1,15 @@
 #ifndef button_h
 #define button_h
+//Presses closer together than this many milliseconds are ignored.  This
+//debounces the button, and keeps the robot from reacting to every press
+//of a child mashing it
+#define BUTTON_HOLDOFF_MS 2500
+
 //Configure the ATmega's port D4 to read a button that connects
-//to ground when pressed
+//to ground when pressed, and post a BUTTON_EVENT when it is pressed
 void setUpButton();
 
 //Returns 0 if the button is unpressed, true otherwise
 int button();
 
-//Returns 1 if the button is in the pressed state of the state machine,
-// and returns 0 otherwise.
-int pressing();
-
-//Advance the state machine one tick.
-void buttonTick();
-
 #endif
-
@@ -0,0 +1,215 @@
+/**Generated by tools/adpcm.py.  Do not edit.
+ * 4-bit IMA ADPCM clips at 8000 Hz, low nibble first.
+ */
+#include <avr/pgmspace.h>
+#include "clips.h"
+
+//Clip 0: accelerometer (placeholder)
+static const unsigned char clip0[1200] PROGMEM=
+{
+  0x77,0x77,0x77,0x77,0x17,0xAA,0xCB,0xAB,0xAA,0x89,0x20,0x44,0x34,0x34,0x23,0x22,
+  0x90,0xCA,0xCC,0xBC,0xCB,0x9A,0x89,0x20,0x53,0x44,0x32,0x33,0x11,0x90,0xDA,0xCC,
+  0xBB,0xAC,0x9A,0x09,0x31,0x45,0x43,0x33,0x23,0x01,0xA9,0xCD,0xDB,0xAB,0xAB,0x8A,
+  0x10,0x44,0x53,0x43,0x22,0x02,0x90,0xCB,0xCC,0xBB,0xAC,0x8A,0x08,0x43,0x44,0x33,
+  0x24,0x12,0x88,0xBB,0xBE,0xBC,0xBB,0x9B,0x10,0x52,0x44,0x43,0x22,0x12,0x98,0xCA,
+  0xBD,0xCB,0xAB,0x8A,0x10,0x53,0x44,0x33,0x32,0x01,0xB8,0xCC,0xCC,0xBB,0xAA,0x09,
+  0x31,0x45,0x34,0x23,0x13,0x80,0xCB,0xDC,0xBB,0xBB,0x99,0x10,0x44,0x44,0x33,0x22,
+  0x01,0xB9,0xCD,0xBC,0xBA,0x9B,0x18,0x53,0x34,0x34,0x33,0x01,0xA9,0xCD,0xCB,0xBB,
+  0x9B,0x08,0x53,0x34,0x34,0x33,0x01,0xB9,0xDC,0xBC,0xBB,0x9A,0x10,0x43,0x45,0x33,
+  0x13,0x01,0xBA,0xBE,0xCC,0xAA,0x89,0x10,0x34,0x44,0x33,0x12,0x88,0xDB,0xDB,0xBB,
+  0xAA,0x09,0x32,0x46,0x33,0x23,0x82,0xB9,0xCD,0xBC,0xAB,0x8A,0x20,0x44,0x44,0x22,
+  0x12,0x98,0xCB,0xCC,0xBB,0x9A,0x18,0x43,0x35,0x34,0x12,0x80,0xCA,0xBD,0xBB,0xAB,
+  0x19,0x52,0x44,0x33,0x13,0x81,0xCB,0xCC,0xAC,0xAA,0x08,0x32,0x45,0x33,0x22,0x91,
+  0xCA,0xBD,0xBC,0x9A,0x08,0x42,0x35,0x33,0x13,0x90,0xDB,0xCC,0xBB,0x9A,0x10,0x53,
+  0x44,0x32,0x11,0xA8,0xDB,0xBC,0xBB,0x89,0x30,0x45,0x43,0x22,0x01,0xBA,0xDC,0xBB,
+  0xAB,0x18,0x52,0x34,0x24,0x12,0xA0,0xCB,0xBD,0xBB,0x99,0x31,0x45,0x43,0x22,0x81,
+  0xBA,0xCD,0xBB,0xAA,0x10,0x63,0x43,0x23,0x11,0xB9,0xCC,0xBC,0x9B,0x09,0x43,0x44,
+  0x33,0x11,0x98,0xCC,0xBC,0xAB,0x09,0x41,0x44,0x33,0x12,0xA0,0xCC,0xDB,0xAA,0x09,
+  0x21,0x35,0x34,0x12,0x98,0xDB,0xBC,0xAB,0x89,0x42,0x44,0x23,0x13,0xA8,0xCC,0xBC,
+  0x9B,0x09,0x42,0x44,0x23,0x12,0xA9,0xDC,0xBB,0x9B,0x19,0x63,0x43,0x23,0x81,0xB9,
+  0xCD,0xBB,0x8A,0x20,0x44,0x34,0x22,0x90,0xDA,0xBC,0xAB,0x89,0x42,0x44,0x23,0x12,
+  0xA9,0xDC,0xBB,0x9B,0x28,0x63,0x43,0x13,0x91,0xCA,0xBC,0xAC,0x09,0x31,0x35,0x24,
+  0x02,0xB8,0xCC,0xAC,0x8A,0x28,0x53,0x43,0x12,0x90,0xCB,0xCC,0x9A,0x08,0x42,0x34,
+  0x32,0x91,0xCA,0xCC,0xAB,0x09,0x31,0x36,0x33,0x01,0xC9,0xBC,0xAD,0x89,0x30,0x44,
+  0x23,0x02,0xB8,0xDC,0xBB,0x8A,0x30,0x54,0x33,0x02,0xA8,0xBD,0xAD,0x8A,0x20,0x53,
+  0x43,0x11,0xA8,0xDB,0xAC,0x8A,0x20,0x63,0x32,0x02,0xA8,0xCC,0xAC,0x99,0x21,0x34,
+  0x34,0x02,0xB9,0xBD,0xBC,0x89,0x31,0x45,0x23,0x01,0xBA,0xBE,0xAB,0x09,0x42,0x44,
+  0x13,0x81,0xCB,0xBC,0xAB,0x18,0x63,0x43,0x12,0x98,0xDB,0xCB,0x99,0x20,0x34,0x34,
+  0x02,0xB9,0xCD,0xAB,0x09,0x41,0x34,0x33,0x80,0xEB,0xCB,0x9A,0x18,0x34,0x34,0x12,
+  0xB8,0xBD,0xBC,0x89,0x41,0x34,0x33,0x80,0xDB,0xBC,0x9B,0x28,0x44,0x24,0x02,0xB8,
+  0xCC,0xBB,0x09,0x42,0x44,0x22,0x90,0xDB,0xBB,0x8B,0x30,0x45,0x33,0x81,0xCA,0xCC,
+  0x9A,0x08,0x53,0x33,0x03,0xB8,0xBE,0xBB,0x09,0x52,0x34,0x13,0xA0,0xCC,0xAC,0x89,
+  0x30,0x35,0x23,0x91,0xEB,0xBB,0x8B,0x30,0x45,0x23,0x81,0xDA,0xCB,0x9A,0x20,0x63,
+  0x23,0x81,0xC9,0xBC,0x9B,0x28,0x44,0x24,0x01,0xBA,0xCC,0x9B,0x28,0x63,0x23,0x01,
+  0xC9,0xBC,0x9B,0x28,0x44,0x24,0x81,0xB9,0xBD,0xAA,0x10,0x35,0x24,0x01,0xCA,0xBC,
+  0x9A,0x20,0x44,0x33,0x81,0xDB,0xBC,0x8A,0x30,0x35,0x14,0x91,0xCB,0xBC,0x89,0x31,
+  0x26,0x13,0xA0,0xBC,0xAD,0x08,0x41,0x43,0x02,0xB8,0xCC,0xAA,0x18,0x53,0x33,0x82,
+  0xCA,0xBD,0x9A,0x30,0x44,0x23,0x91,0xEB,0xAB,0x8A,0x42,0x34,0x13,0xB8,0xCD,0xAA,
+  0x19,0x34,0x34,0x81,0xD9,0xBB,0x9B,0x31,0x36,0x23,0xA0,0xCC,0xAC,0x19,0x42,0x43,
+  0x82,0xB9,0xBD,0xAA,0x30,0x45,0x22,0x90,0xDB,0xBB,0x09,0x43,0x25,0x02,0xC9,0xCB,
+  0x9A,0x30,0x44,0x13,0x90,0xCC,0xAB,0x09,0x63,0x23,0x01,0xCA,0xBC,0x8A,0x31,0x26,
+  0x13,0xA9,0xCC,0x9B,0x28,0x44,0x23,0x90,0xDB,0xAC,0x08,0x32,0x35,0x01,0xCA,0xBC,
+  0x99,0x41,0x53,0x02,0xA8,0xCC,0x9A,0x20,0x53,0x13,0xA0,0xDB,0xBB,0x18,0x44,0x33,
+  0x91,0xEB,0xAB,0x09,0x52,0x33,0x82,0xDA,0xAC,0x8A,0x32,0x26,0x02,0xB9,0xBD,0x8A,
+  0x31,0x35,0x03,0xB8,0xBE,0x9A,0x30,0x44,0x13,0xB8,0xCC,0x9B,0x20,0x35,0x23,0xA8,
+  0xCD,0xAA,0x20,0x53,0x23,0xA8,0xCC,0x9B,0x28,0x44,0x13,0xA0,0xCC,0xAA,0x28,0x44,
+  0x22,0xA0,0xCC,0xAA,0x28,0x44,0x13,0xA0,0xCC,0x9B,0x28,0x35,0x13,0xA8,0xBD,0xAB,
+  0x30,0x45,0x12,0xA8,0xCC,0x9A,0x30,0x44,0x02,0xB8,0xCC,0x8A,0x31,0x44,0x11,0xBA,
+  0xCC,0x89,0x32,0x25,0x82,0xCA,0xAC,0x09,0x42,0x24,0x91,0xDA,0xAB,0x18,0x53,0x23,
+  0xA0,0xCC,0xAA,0x20,0x44,0x12,0xA8,0xBD,0x9A,0x31,0x26,0x02,0xC9,0xCB,0x09,0x32,
+  0x25,0x81,0xCB,0xAC,0x18,0x53,0x13,0xA0,0xCC,0x9A,0x20,0x35,0x02,0xB9,0xBD,0x8A,
+  0x43,0x34,0x91,0xDA,0xBB,0x18,0x44,0x23,0xA8,0xBD,0x9B,0x41,0x34,0x02,0xCA,0xBC,
+  0x09,0x43,0x24,0x90,0xDB,0x9B,0x20,0x44,0x12,0xB9,0xBD,0x0A,0x42,0x24,0x81,0xDB,
+  0xAB,0x20,0x44,0x12,0xB9,0xCC,0x89,0x41,0x24,0x80,0xCB,0xAB,0x38,0x44,0x03,0xC8,
+  0xCB,0x0A,0x42,0x24,0x90,0xCB,0xAB,0x30,0x35,0x03,0xC9,0xAD,0x09,0x42,0x14,0x90,
+  0xBC,0x9A,0x40,0x24,0x02,0xCB,0xAC,0x18,0x53,0x13,0xA9,0xBD,0x0A,0x42,0x24,0x90,
+  0xCB,0x9C,0x30,0x34,0x02,0xDA,0xBB,0x29,0x63,0x13,0xB8,0xCC,0x89,0x32,0x25,0x90,
+  0xDB,0x9A,0x30,0x34,0x02,0xDB,0xBB,0x28,0x35,0x13,0xC9,0xBC,0x1A,0x53,0x23,0xA8,
+  0xBD,0x8B,0x52,0x33,0xA1,0xCC,0x9B,0x31,0x35,0x01,0xDB,0xAB,0x38,0x44,0x02,0xC9,
+  0xAC,0x18,0x43,0x13,0xB9,0xAE,0x09,0x42,0x14,0xA8,0xCB,0x8A,0x42,0x24,0xA0,0xDB,
+  0x8A,0x31,0x25,0x91,0xDB,0x9A,0x30,0x25,0x92,0xCB,0xAB,0x40,0x34,0x81,0xDA,0xAB,
+  0x20,0x35,0x82,0xCA,0xAC,0x10,0x44,0x01,0xC9,0xAB,0x28,0x44,0x02,0xBA,0xAD,0x18,
+  0x34,0x03,0xCA,0xAC,0x18,0x34,0x03,0xD9,0xBB,0x29,0x35,0x03,0xD9,0xBB,0x18,0x35,
+  0x03,0xCA,0xAC,0x18,0x44,0x02,0xCA,0xAB,0x28,0x35,0x02,0xCB,0xAC,0x20,0x34,0x02,
+  0xDB,0xAB,0x30,0x35,0x81,0xDB,0x9B,0x40,0x43,0x91,0xCB,0x9B,0x41,0x24,0x91,0xBC,
+  0x9B,0x52,0x33,0xB0,0xCC,0x8A,0x43,0x14,0xA8,0xBC,0x09,0x53,0x13,0xC9,0xBB,0x29,
+  0x44,0x03,0xCA,0xAC,0x20,0x53,0x81,0xCA,0x9B,0x40,0x43,0x90,0xCB,0x9A,0x42,0x24,
+  0xA8,0xBC,0x89,0x34,0x14,0xB9,0xBC,0x29,0x44,0x02,0xCA,0xAB,0x30,0x35,0x91,0xDB,
+  0x8B,0x41,0x14,0xA0,0xCB,0x0A,0x53,0x12,0xC8,0xBB,0x28,0x44,0x82,0xCA,0xAB,0x31,
+  0x35,0xA1,0xCC,0x89,0x42,0x13,0xB8,0xBD,0x18,0x34,0x02,0xDA,0xAB,0x31,0x25,0x91,
+  0xBC,0x8B,0x53,0x23,0xB9,0xBD,0x18,0x44,0x01,0xCA,0x9B,0x31,0x25,0xA0,0xCB,0x0A,
+  0x53,0x12,0xC9,0xAB,0x38,0x44,0x91,0xCB,0x8A,0x51,0x22,0xB8,0xBC,0x18,0x44,0x01,
+  0xBB,0x9C,0x31,0x25,0x98,0xBC,0x19,0x43,0x03,0xCB,0xAB,0x40,0x24,0x90,0xBC,0x1A,
+  0x43,0x13,0xDA,0x9B,0x20,0x25,0x90,0xCB,0x89,0x43,0x03,0xBA,0xAC,0x30,0x34,0xA0,
+  0xDB,0x09,0x42,0x02,0xB9,0x9C,0x21,0x23,0xA0,0xCB,0x19,0x32,0x82,0xAA,0x0A,0x11,
+};
+
+//Clip 1: button (placeholder)
+static const unsigned char clip1[600] PROGMEM=
+{
+  0x77,0xF7,0xFF,0x77,0xD7,0x8E,0x43,0x91,0xBC,0x31,0x04,0xDA,0x19,0x24,0xC8,0x8A,
+  0x42,0x91,0xAC,0x30,0x05,0xCA,0x19,0x24,0xB9,0x8B,0x53,0xA2,0xBC,0x40,0x04,0xBB,
+  0x2A,0x25,0xB8,0x8C,0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x8B,0x43,0xA2,
+  0xBC,0x31,0x05,0xCA,0x19,0x24,0xC8,0x8B,0x43,0x91,0xAC,0x30,0x05,0xBB,0x2A,0x25,
+  0xB8,0x8D,0x33,0xA2,0xAD,0x30,0x05,0xBB,0x2A,0x25,0xB8,0x9C,0x53,0x91,0xAC,0x30,
+  0x04,0xCA,0x19,0x24,0xC8,0x8B,0x43,0xA2,0xBC,0x41,0x03,0xDB,0x19,0x24,0xB8,0x8C,
+  0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x9A,0x43,0x91,0xAC,0x30,0x05,0xBB,
+  0x2A,0x25,0xB8,0x8D,0x42,0x91,0xAC,0x40,0x12,0xCB,0x19,0x24,0xB8,0x8C,0x52,0x91,
+  0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x8B,0x43,0xA2,0xBC,0x41,0x03,0xDB,0x19,0x24,
+  0xB8,0x8C,0x52,0xA1,0xAB,0x40,0x13,0xBC,0x2A,0x25,0xC8,0x8B,0x53,0xA1,0xBB,0x50,
+  0x03,0xCB,0x2A,0x34,0xC8,0x8C,0x33,0xA2,0xAD,0x30,0x14,0xDB,0x19,0x24,0xB8,0x8C,
+  0x42,0x91,0xAC,0x40,0x03,0xCB,0x2A,0x24,0xB8,0x8D,0x42,0x91,0xAC,0x40,0x03,0xCB,
+  0x19,0x24,0xB8,0x8D,0x33,0xA2,0xAD,0x30,0x05,0xCA,0x19,0x24,0xB9,0x9B,0x44,0x91,
+  0xAC,0x30,0x04,0xDA,0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x40,0x12,0xCB,0x2A,0x34,
+  0xB9,0x8D,0x42,0x91,0xAC,0x40,0x12,0xCB,0x19,0x24,0xB8,0x8C,0x52,0x91,0xAC,0x30,
+  0x04,0xCA,0x19,0x24,0xC8,0x8B,0x43,0xA2,0xBC,0x41,0x03,0xDB,0x19,0x24,0xB8,0x8C,
+  0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x9A,0x43,0x91,0xAC,0x30,0x14,0xDB,
+  0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x40,0x03,0xCB,0x2A,0x34,0xC9,0x8B,0x53,0x91,
+  0xAC,0x30,0x04,0xDA,0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x40,0x02,0xCA,0x19,0x24,
+  0xB8,0x8C,0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x9A,0x43,0xA2,0xBC,0x31,
+  0x05,0xCA,0x19,0x24,0xC8,0x9A,0x43,0x91,0xAC,0x30,0x04,0xDA,0x19,0x24,0xB8,0x8C,
+  0x42,0x91,0xAC,0x40,0x03,0xCB,0x2A,0x24,0xB8,0x8D,0x42,0x91,0xAC,0x40,0x12,0xCB,
+  0x19,0x24,0xB8,0x8C,0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x9A,0x43,0x91,
+  0xAC,0x30,0x05,0xCA,0x19,0x24,0xB9,0x9B,0x44,0x91,0xAC,0x30,0x04,0xDA,0x19,0x24,
+  0xB8,0x8C,0x42,0x91,0xAC,0x40,0x12,0xCB,0x19,0x24,0xB8,0x8D,0x42,0x91,0xAC,0x31,
+  0x03,0xDB,0x2A,0x34,0xB9,0x8D,0x33,0xA2,0xAD,0x40,0x03,0xDB,0x19,0x24,0xB8,0x8C,
+  0x42,0xA2,0xAC,0x40,0x03,0xCB,0x2A,0x24,0xB8,0x8D,0x42,0x91,0xAC,0x40,0x12,0xCB,
+  0x19,0x24,0xB8,0x8C,0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x9A,0x43,0x91,
+  0xAC,0x30,0x04,0xDA,0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x40,0x12,0xCB,0x19,0x24,
+  0xB8,0x8C,0x52,0x91,0xAC,0x30,0x04,0xCA,0x19,0x24,0xC8,0x8A,0x42,0x91,0xAC,0x30,
+  0x04,0xDA,0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x31,0x03,0xDB,0x19,0x24,0xB8,0x8D,
+  0x33,0xA2,0xAD,0x30,0x04,0xCA,0x2A,0x24,0xC8,0x8B,0x53,0x91,0xAC,0x30,0x04,0xCA,
+  0x19,0x24,0xB9,0x8B,0x53,0x91,0xBC,0x31,0x05,0xBB,0x2A,0x25,0xB8,0x8C,0x42,0xA2,
+  0xAC,0x40,0x12,0xCB,0x2A,0x24,0xB8,0x8D,0x42,0x91,0x9C,0x30,0x03,0xDB,0x19,0x24,
+  0xB8,0x8C,0x42,0x91,0xAC,0x40,0x02,0xCA,0x19,0x24,0xB8,0x8C,0x42,0x91,0xAC,0x40,
+  0x02,0xCA,0x19,0x24,0xB8,0x8C,0x33,0xA2,0xAD,0x30,0x04,0xCA,0x19,0x24,0xB9,0x8B,
+  0x53,0x91,0xAC,0x30,0x04,0xCA,0x29,0x32,0xB9,0x8C,0x33,0xA2,0x9D,0x30,0x02,0xCA,
+  0x19,0x23,0xB8,0x0B,0x32,0xA1,0x9A,0x11,
+};
+
+//Clip 2: temperature (placeholder)
+static const unsigned char clip2[1200] PROGMEM=
+{
+  0x77,0x77,0x77,0xFF,0xDF,0x20,0x34,0x13,0xA0,0xDC,0xAA,0x19,0x52,0x33,0x01,0xDA,
+  0xCB,0x8A,0x31,0x35,0x22,0xA9,0xCD,0x9A,0x18,0x34,0x24,0x90,0xDB,0xAB,0x09,0x63,
+  0x23,0x81,0xDA,0xBB,0x0A,0x52,0x24,0x02,0xCA,0xCB,0x8A,0x32,0x35,0x02,0xC9,0xBC,
+  0x8A,0x41,0x34,0x02,0xC9,0xBC,0x8A,0x41,0x34,0x02,0xC9,0xBC,0x8A,0x41,0x34,0x02,
+  0xD9,0xBB,0x8A,0x52,0x43,0x01,0xCA,0xCB,0x09,0x42,0x43,0x81,0xCB,0xCB,0x08,0x42,
+  0x24,0x91,0xCB,0xBB,0x19,0x54,0x13,0x91,0xBC,0xAC,0x18,0x44,0x22,0xA0,0xBC,0x9C,
+  0x28,0x34,0x14,0xA8,0xDB,0x9B,0x20,0x35,0x13,0xB8,0xBD,0xAB,0x31,0x45,0x12,0xB8,
+  0xCC,0x9A,0x30,0x44,0x12,0xB8,0xCC,0x9A,0x30,0x44,0x12,0xA8,0xBD,0xAA,0x30,0x44,
+  0x13,0xA0,0xBD,0xAB,0x28,0x35,0x24,0x90,0xBC,0xAC,0x19,0x53,0x23,0x82,0xDB,0xCB,
+  0x89,0x32,0x35,0x02,0xB9,0xBD,0x9B,0x38,0x45,0x13,0x90,0xDB,0xBB,0x09,0x43,0x35,
+  0x01,0xB9,0xBD,0x9B,0x20,0x35,0x24,0x91,0xCB,0xBC,0x89,0x31,0x45,0x12,0x98,0xDB,
+  0xAB,0x0A,0x43,0x34,0x13,0xB8,0xCD,0xAB,0x08,0x52,0x43,0x11,0xA8,0xCC,0xBA,0x08,
+  0x42,0x34,0x13,0xA8,0xBD,0xBC,0x09,0x41,0x34,0x13,0x90,0xEB,0xBB,0x9A,0x31,0x45,
+  0x32,0x81,0xCA,0xBC,0xAB,0x18,0x44,0x24,0x12,0xA8,0xCC,0xBB,0x8A,0x32,0x36,0x33,
+  0x81,0xDA,0xBC,0xAB,0x18,0x53,0x34,0x13,0x98,0xCC,0xAC,0x9A,0x21,0x34,0x25,0x01,
+  0xB8,0xCC,0xBB,0x09,0x42,0x34,0x14,0x81,0xCA,0xBC,0x9B,0x19,0x34,0x35,0x22,0x98,
+  0xCC,0xCB,0x8A,0x20,0x63,0x32,0x02,0xB9,0xDC,0xAA,0x0A,0x41,0x53,0x22,0x80,0xCA,
+  0xDB,0x9A,0x18,0x43,0x34,0x02,0xA0,0xBD,0xAC,0x8A,0x31,0x35,0x24,0x00,0xCA,0xBC,
+  0x9B,0x18,0x44,0x43,0x11,0xB8,0xCC,0xAB,0x09,0x42,0x34,0x23,0xA0,0xCC,0xBC,0x99,
+  0x31,0x45,0x22,0x80,0xCB,0xBC,0x8A,0x30,0x54,0x22,0x81,0xCB,0xBC,0x9A,0x31,0x35,
+  0x24,0x90,0xDA,0xBB,0x8A,0x31,0x36,0x23,0xA0,0xDC,0xAB,0x09,0x42,0x34,0x03,0xB9,
+  0xCD,0x9A,0x18,0x34,0x24,0x81,0xDA,0xCB,0x89,0x31,0x35,0x12,0xB8,0xBD,0xAB,0x28,
+  0x45,0x13,0x91,0xDB,0xBB,0x09,0x53,0x24,0x82,0xBA,0xAE,0x8A,0x31,0x35,0x12,0xC9,
+  0xCB,0x9B,0x31,0x35,0x13,0xB8,0xCD,0x9A,0x38,0x44,0x12,0xA0,0xCC,0x9B,0x20,0x34,
+  0x24,0xA8,0xCC,0x9B,0x20,0x44,0x22,0xA8,0xCC,0x9B,0x20,0x44,0x22,0xA8,0xBD,0x9B,
+  0x30,0x35,0x13,0xB8,0xBE,0x9A,0x31,0x35,0x03,0xB9,0xBE,0x8A,0x31,0x35,0x03,0xCA,
+  0xBC,0x8A,0x42,0x34,0x82,0xCA,0xBC,0x89,0x43,0x34,0x81,0xCB,0xBC,0x19,0x43,0x24,
+  0x81,0xDB,0xBB,0x18,0x53,0x24,0x90,0xCB,0xBB,0x18,0x44,0x33,0x90,0xCC,0x9C,0x08,
+  0x53,0x22,0x90,0xCB,0xAC,0x18,0x53,0x23,0x90,0xDB,0xBB,0x19,0x44,0x33,0x91,0xDB,
+  0xAC,0x09,0x42,0x24,0x82,0xCA,0xCB,0x0A,0x31,0x35,0x12,0xB9,0xCD,0x9A,0x20,0x44,
+  0x22,0x98,0xBC,0xAC,0x18,0x52,0x23,0x82,0xCA,0xBC,0x9A,0x31,0x36,0x22,0xA8,0xCC,
+  0xAB,0x19,0x62,0x23,0x02,0xC9,0xBC,0x9B,0x20,0x54,0x22,0x81,0xCA,0xBC,0x8A,0x30,
+  0x35,0x33,0x90,0xCC,0xAC,0x8A,0x31,0x35,0x23,0x90,0xEB,0xBB,0x9A,0x41,0x34,0x24,
+  0x90,0xCA,0xBC,0x9A,0x30,0x44,0x33,0x82,0xDA,0xDB,0x9A,0x18,0x43,0x24,0x12,0xA9,
+  0xCC,0xBB,0x89,0x42,0x44,0x22,0x80,0xCB,0xBC,0x9B,0x20,0x44,0x24,0x02,0xA9,0xCC,
+  0xAB,0x0A,0x41,0x34,0x14,0x81,0xCA,0xBC,0xAA,0x18,0x53,0x34,0x12,0x98,0xCC,0xBB,
+  0x8B,0x30,0x45,0x33,0x02,0xC9,0xBC,0xAC,0x0A,0x32,0x45,0x22,0x81,0xCA,0xBC,0xAB,
+  0x18,0x53,0x34,0x13,0x98,0xCC,0xAC,0x9A,0x20,0x44,0x33,0x02,0xB9,0xBE,0xBB,0x89,
+  0x43,0x35,0x23,0x80,0xBC,0xBD,0x9B,0x10,0x54,0x23,0x02,0xB8,0xCD,0xAA,0x89,0x42,
+  0x34,0x13,0x90,0xEB,0xBB,0x9A,0x30,0x36,0x33,0x81,0xDA,0xBC,0x9B,0x28,0x54,0x32,
+  0x01,0xB9,0xBE,0xAA,0x18,0x44,0x33,0x02,0xBA,0xBE,0xAB,0x18,0x44,0x24,0x82,0xB9,
+  0xBD,0x9B,0x28,0x54,0x23,0x81,0xCB,0xBC,0x8A,0x30,0x45,0x22,0xA0,0xDB,0xBB,0x09,
+  0x53,0x43,0x02,0xB9,0xBD,0x9B,0x20,0x45,0x22,0x90,0xDB,0xBB,0x09,0x53,0x24,0x82,
+  0xC9,0xCB,0x8A,0x30,0x35,0x13,0xB8,0xCD,0x9A,0x28,0x44,0x22,0xA0,0xBC,0xAC,0x18,
+  0x34,0x24,0x91,0xBC,0xAC,0x19,0x53,0x23,0x81,0xEB,0xAB,0x19,0x52,0x33,0x91,0xDB,
+  0xBB,0x1A,0x44,0x33,0x81,0xCC,0xAC,0x08,0x43,0x24,0x90,0xDA,0xAA,0x19,0x53,0x23,
+  0x90,0xCC,0xAA,0x29,0x44,0x13,0xA0,0xCC,0xAA,0x10,0x35,0x13,0xA8,0xBD,0xAB,0x40,
+  0x34,0x13,0xB9,0xCD,0x9A,0x31,0x44,0x02,0xA9,0xBD,0x8A,0x41,0x43,0x02,0xC9,0xAC,
+  0x8A,0x32,0x35,0x82,0xD9,0xBB,0x0A,0x42,0x25,0x01,0xBA,0xBD,0x89,0x42,0x34,0x01,
+  0xCA,0xBC,0x89,0x42,0x24,0x02,0xCA,0xCB,0x8A,0x32,0x35,0x12,0xBA,0xBE,0x8A,0x31,
+  0x44,0x12,0xB8,0xCC,0xAA,0x20,0x35,0x13,0xA0,0xCC,0xAB,0x19,0x44,0x33,0x81,0xDB,
+  0xCB,0x89,0x31,0x35,0x03,0xB8,0xBD,0x9C,0x28,0x53,0x23,0x91,0xDA,0xCB,0x89,0x31,
+  0x44,0x12,0xA8,0xDB,0xAB,0x09,0x53,0x24,0x02,0xB9,0xCC,0x9B,0x28,0x53,0x33,0x82,
+  0xCA,0xCC,0x9A,0x28,0x53,0x33,0x01,0xCA,0xCC,0x9A,0x28,0x53,0x23,0x02,0xC9,0xBC,
+  0x9C,0x08,0x43,0x34,0x11,0xB8,0xCC,0xBB,0x09,0x42,0x35,0x12,0x90,0xDB,0xCB,0x8A,
+  0x20,0x44,0x23,0x82,0xC9,0xBC,0xAB,0x09,0x53,0x34,0x23,0x98,0xCC,0xAC,0x9A,0x20,
+  0x44,0x33,0x02,0xC9,0xDB,0xAB,0x89,0x42,0x34,0x33,0x80,0xDB,0xBC,0xAB,0x18,0x44,
+  0x43,0x12,0xA0,0xDB,0xAC,0x9A,0x20,0x44,0x33,0x02,0xB9,0xCD,0xAB,0x0A,0x41,0x34,
+  0x24,0x80,0xBA,0xCD,0x9A,0x08,0x43,0x34,0x12,0x98,0xCC,0xBB,0x8B,0x30,0x45,0x33,
+  0x82,0xC9,0xCC,0xAA,0x19,0x42,0x34,0x22,0xA0,0xCC,0xCB,0x8A,0x21,0x44,0x23,0x01,
+  0xCA,0xAD,0x9B,0x18,0x53,0x43,0x11,0xA9,0xCC,0xAB,0x19,0x42,0x34,0x13,0xA8,0xBD,
+  0xBC,0x09,0x42,0x34,0x13,0xA8,0xDC,0xAB,0x09,0x42,0x34,0x22,0xB8,0xDC,0xAB,0x08,
+  0x52,0x33,0x03,0xB9,0xBE,0xAB,0x28,0x44,0x33,0x82,0xDB,0xBC,0x8A,0x31,0x35,0x23,
+  0xB0,0xDC,0xAB,0x08,0x53,0x33,0x82,0xCA,0xBD,0x8A,0x31,0x35,0x13,0xB8,0xBD,0x9C,
+  0x28,0x53,0x23,0x90,0xDB,0xAC,0x08,0x43,0x33,0x81,0xEA,0xBB,0x89,0x43,0x34,0x02,
+  0xDA,0xBB,0x0B,0x51,0x43,0x02,0xC9,0xCB,0x8A,0x41,0x43,0x02,0xC9,0xCB,0x8A,0x41,
+  0x43,0x01,0xB9,0xCC,0x89,0x31,0x25,0x02,0xBA,0xBD,0x89,0x42,0x43,0x82,0xCA,0xAC,
+  0x0A,0x52,0x23,0x81,0xDA,0xBB,0x19,0x53,0x33,0x91,0xEB,0xAB,0x19,0x34,0x24,0x90,
+  0xDB,0xAB,0x28,0x34,0x24,0xA0,0xCC,0xAA,0x20,0x53,0x13,0xB0,0xCC,0x9A,0x38,0x44,
+  0x12,0xA8,0xBD,0x9A,0x30,0x35,0x12,0xB8,0xBD,0x9B,0x31,0x35,0x13,0xB8,0xBE,0x9A,
+  0x30,0x44,0x03,0xA8,0xCC,0xAA,0x30,0x34,0x14,0xA8,0xDB,0x9B,0x28,0x63,0x22,0x88,
+  0xCB,0x9C,0x19,0x42,0x33,0x91,0xDA,0xBB,0x0A,0x51,0x43,0x02,0xB9,0xBC,0xAB,0x30,
+  0x45,0x22,0x90,0xDB,0xAB,0x09,0x52,0x33,0x02,0xBA,0xCD,0x8A,0x28,0x53,0x22,0x80,
+  0xBB,0xAD,0x8A,0x31,0x35,0x12,0xA0,0xBC,0xAC,0x09,0x42,0x33,0x13,0xB9,0xCC,0xAB,
+  0x08,0x43,0x33,0x03,0xA9,0xBD,0xAB,0x08,0x43,0x33,0x11,0xA9,0xBB,0x9B,0x18,0x22,
+};
+
+const audioClip audioClips[AUDIO_CLIPS] PROGMEM=
+{
+  {clip0,sizeof(clip0)},
+  {clip1,sizeof(clip1)},
+  {clip2,sizeof(clip2)},
+};
@@ -0,0 +1,10 @@
+//Generated by tools/adpcm.py.  Do not edit.
+#ifndef clips_h
+#define clips_h
+#include "audio.h"
+
+#define AUDIO_CLIPS 3
+
+extern const audioClip audioClips[AUDIO_CLIPS];
+
+#endif
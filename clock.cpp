@@ -0,0 +1,26 @@
+/**This library reads the millisecond clock.  The count is wider than a
+ * byte, so the timer interrupt is held off while it is read, and the
+ * differences are taken in unsigned arithmetic so they survive the clock
+ * wrapping.
+ */
+#include <util/atomic.h>
+#include "clock.h"
+
+volatile unsigned long clockMs;
+
+unsigned long clockMillis()
+{
+  unsigned long ms;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ms=clockMs;}
+  return ms;
+}
+
+unsigned int clockNow()
+{
+  unsigned int ms;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ms=clockMs;}
+  return ms;
+}
+
+int clockElapsed(unsigned int since, unsigned int ms)
+  {return (unsigned int)(clockNow()-since)>=ms;}
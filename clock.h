@@ -0,0 +1,24 @@
+#ifndef clock_h
+#define clock_h
+/**This library keeps a monotonic millisecond clock.  It is advanced by
+ * the Timer 0 interrupt in mickeyMouse.ino, which also counts out the
+ * ticks from it, so delays can be given in milliseconds however fast the
+ * state machines tick.
+ */
+
+//Milliseconds since the timer was started.  Only the timer interrupt
+//writes this; read it with clockMillis() or clockNow()
+extern volatile unsigned long clockMs;
+
+//Returns the milliseconds since the timer was started
+unsigned long clockMillis();
+
+//Returns the low 16 bits of clockMillis(), which is enough to time
+//anything shorter than a minute, and is cheaper to read and compare
+unsigned int clockNow();
+
+//Returns 1 once "ms" milliseconds have passed since clockNow()
+//returned "since", and 0 before then
+int clockElapsed(unsigned int since, unsigned int ms);
+
+#endif
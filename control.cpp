@@ -1,22 +1,37 @@
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include "button.h"
 #include "thermometer.h"
 #include "accelerometer.h"
 #include "servo.h"
 #include "voice.h"
+#include "events.h"
+#include "fsm.h"
+#include "prng.h"
+#include "clock.h"
+#include "posture.h"
+#include "settings.h"
+#include "standby.h"
+#include "control.h"
 
-//This returns a random number based on Timer1.  The number will be between 0 and 5
-//(though 5 will be highly unprobable).The implementation assumes that Timer1 has
-//already been configured, and that it resets on compare at 20,000
-int getTargetAngle()
+//The poses a joint picks from, and how often each is picked in each
+//posture.  Lying down the joints keep near the middle, so the robot
+//doesn't push itself over, and upside down it flails
+#define TARGET_ANGLES 5
+const unsigned char targetAngles[TARGET_ANGLES] PROGMEM={45,70,90,110,135};
+const unsigned char targetWeights[POSTURES][TARGET_ANGLES] PROGMEM=
 {
-  int x=TCNT1/4000;
-  if(x==0) return 45;
-  else if(x==1) return 70;
-  else if(x==2) return 90;
-  else if(x==3) return 110;
-  else return 135;
-}
+  {1,1,1,1,1},  //POSTURE_UPRIGHT
+  {0,2,1,2,0},  //POSTURE_FACE_DOWN
+  {0,1,1,1,0},  //POSTURE_FACE_UP
+  {0,1,2,1,0},  //POSTURE_ON_SIDE
+  {3,1,0,1,3},  //POSTURE_UPSIDE_DOWN
+};
+
+//This returns one of the target angles, chosen at random to suit the
+//way up the robot is
+int getTargetAngle()
+  {return pgm_read_byte(&targetAngles[randomChoice(targetWeights[posture()],TARGET_ANGLES)]);}
 
 void setTargetAngles()
 {
@@ -24,85 +39,94 @@ void setTargetAngles()
   if(!rightAtTarget()) setRightTarget(getTargetAngle());
   if(!spineAtTarget()) setSpineTarget(getTargetAngle());
 }
-enum control_ST {init_CONTROL,sense_CONTROL,soundDisable_CONTROL,setMove_CONTROL,waitForMotion_CONTROL,delaySense_CONTROL};
+enum control_ST {init_CONTROL,sense_CONTROL,setMove_CONTROL,waitForMotion_CONTROL,delaySense_CONTROL,park_CONTROL};
 
-void controlTick()
+static int moveNumber=0;
+static unsigned int pauseStart;
+static unsigned int idleStart;
+static unsigned char shaken;
+static unsigned char pushed;
+
+static int wasShaken(){return shaken;}
+static int wasPushed(){return pushed;}
+static int movesDone(){return moveNumber>=6;}
+static int jointArrived(){return spineAtTarget()|leftAtTarget()|rightAtTarget();}
+static int pauseDone(){return clockElapsed(pauseStart,settings.pauseMs);}
+static int idleTooLong(){return clockElapsed(idleStart,CONTROL_STANDBY_MS);}
+static int parked(){return servosDetached()==SERVO_JOINTS && !voicePlaying();}
+
+//The sound is queued, so the motion can start at once
+static void reactToShake(){enableAccelerometerSound();}
+static void reactToButton(){enableButtonSound();}
+
+static void startPause()
 {
-  static control_ST state=init_CONTROL;
-  static int moveNumber=0;
-  static int delayCount=0;
-  
-  switch(state)
-  {
-  case init_CONTROL:
-    state=sense_CONTROL;
-    break;
-  case sense_CONTROL:
-    if(accelerating())
-    {
-      enableAccelerometerSound();
-      state=soundDisable_CONTROL;
-    }
-    else if(pressing())
-    {
-      enableButtonSound();
-      state=soundDisable_CONTROL;
-    }
-    else state=sense_CONTROL;
-    break;
-  case soundDisable_CONTROL:
-    if(delayCount>=7)
-    {
-      state=setMove_CONTROL;
-      disableAudio();
-      delayCount=0;
-    }
-    break;
-  case setMove_CONTROL:
-    state=waitForMotion_CONTROL;
-    break;
-  case waitForMotion_CONTROL:
-    if(moveNumber>=6)
-    {
-      state=delaySense_CONTROL;
-      moveNumber=0;
-    }
-    else if(spineAtTarget()|leftAtTarget()|rightAtTarget()) state=setMove_CONTROL;
-    break;
-  case delaySense_CONTROL:
-    if(delayCount>=160)
-    {
-      state=sense_CONTROL;
-      delayCount=0;
-    }
-    break;
-  default:
-    break;
-  }
+  moveNumber=0;
+  pauseStart=clockNow();
+}
 
+static void nextMove()
+{
+  moveNumber++;
+  setTargetAngles();
+}
 
-  switch(state)
-  {
-  case init_CONTROL:
-    break;
-  case sense_CONTROL:
-    break;
-  case soundDisable_CONTROL:
-    delayCount++;
-    break;
-  case setMove_CONTROL:
-    moveNumber++;
-    setTargetAngles();
-    break;
-  case waitForMotion_CONTROL:
-    break;
-  case delaySense_CONTROL:
-    delayCount++;
-    break;
-  default:
-    break;
-  }
+static void startIdle(){idleStart=clockNow();}
+
+/**The joints are sent to the park angle, and sleep waits for each to
+ * have held there until it is detached
+ */
+static void park()
+{
+  setLeftTarget(CONTROL_PARK_ANGLE);
+  setRightTarget(CONTROL_PARK_ANGLE);
+  setSpineTarget(CONTROL_PARK_ANGLE);
 }
 
+/**standby() returns when the robot wakes.  A press that woke it is
+ * already posted, and is reacted to on the next tick
+ */
+static void goToSleep()
+{
+  standby();
+  startIdle();
+}
+
+constexpr fsmTransition controlTransitions[] PROGMEM=
+{
+  FSM_ROW(init_CONTROL,          0,            startIdle,     sense_CONTROL),
+  FSM_ROW(sense_CONTROL,         wasShaken,    reactToShake,  setMove_CONTROL),
+  FSM_ROW(sense_CONTROL,         wasPushed,    reactToButton, setMove_CONTROL),
+  FSM_ROW(sense_CONTROL,         idleTooLong,  park,          park_CONTROL),
+  FSM_ROW(setMove_CONTROL,       0,            0,             waitForMotion_CONTROL),
+  FSM_ROW(waitForMotion_CONTROL, movesDone,    startPause,    delaySense_CONTROL),
+  FSM_ROW(waitForMotion_CONTROL, jointArrived, 0,             setMove_CONTROL),
+  FSM_ROW(delaySense_CONTROL,    pauseDone,    startIdle,     sense_CONTROL),
+  FSM_ROW(park_CONTROL,          wasShaken,    reactToShake,  setMove_CONTROL),
+  FSM_ROW(park_CONTROL,          wasPushed,    reactToButton, setMove_CONTROL),
+  FSM_ROW(park_CONTROL,          parked,       goToSleep,     sense_CONTROL),
+};
+constexpr fsmAction controlActions[] PROGMEM={0,0,nextMove,0,0,0};
+#ifdef FSM_EXPORT
+const char* const controlNames[]={"init","sense","setMove","waitForMotion","delaySense","park"};
+#endif
+FSM_CHECK(control);
+FSM_MACHINE(control);
+
+void controlTick()
+{
+  static unsigned char state=init_CONTROL;
 
-
+  //Take every event that arrived since the last tick.  Events that arrive
+  //while a reaction is already under way are dropped, as they always were
+  shaken=0;
+  pushed=0;
+  event e;
+  while(nextEvent(&e))
+  {
+    if(e.type==SHAKE_EVENT) shaken=1;
+    else if(e.type==BUTTON_EVENT) pushed=1;
+  }
+
+  state=fsmStep(&controlMachine,state);
+}
@@ -1,3 +1,13 @@
+//The default wait after a reaction before sensing again, in milliseconds.
+//The value in use is kept in the settings
+#define CONTROL_PAUSE_MS 2500
+
+//How long the robot waits to be shaken or pushed before it parks its
+//joints and goes to sleep (see standby.h), in milliseconds, and the angle
+//the joints are parked at
+#define CONTROL_STANDBY_MS 60000
+#define CONTROL_PARK_ANGLE 90
+
 //Advance the state machine one tick
 
 void controlTick();
\ No newline at end of file
@@ -0,0 +1,59 @@
+/**This library implements the single producer, single consumer event
+ * rings.  An event is written into its slot before the head is moved past
+ * it, and copied out of its slot before the tail is moved past it, so
+ * neither side ever sees a slot the other is still writing.  The compiler
+ * barriers stop those slot accesses from being moved across the volatile
+ * head and tail stores.
+ */
+#include "events.h"
+#include "clock.h"
+
+#define barrier() __asm__ __volatile__("":::"memory")
+
+eventQueue isrEvents;
+eventQueue taskEvents;
+
+int postEvent(eventQueue* queue, unsigned char type, unsigned char data)
+{
+  unsigned char head=queue->head;
+  unsigned char next=(head+1)&(EVENT_QUEUE_LENGTH-1);
+  if(next==queue->tail)
+  {
+    queue->dropped++;
+    return 0;
+  }
+  event* e=&queue->slots[head];
+  e->type=type;
+  e->data=data;
+  e->time=clockNow();
+  barrier();
+  queue->head=next;
+  return 1;
+}
+
+/**Returns the oldest event in a queue without taking it, or 0
+ */
+static event* peek(eventQueue* queue)
+{
+  if(queue->tail==queue->head) return 0;
+  barrier();
+  return &queue->slots[queue->tail];
+}
+
+static void take(eventQueue* queue, event* e)
+{
+  *e=queue->slots[queue->tail];
+  barrier();
+  queue->tail=(queue->tail+1)&(EVENT_QUEUE_LENGTH-1);
+}
+
+int nextEvent(event* e)
+{
+  event* fromIsr=peek(&isrEvents);
+  event* fromTask=peek(&taskEvents);
+  //Take whichever is older; the difference handles the clock wrapping
+  if(fromIsr && (!fromTask || (int)(fromIsr->time-fromTask->time)<=0)) take(&isrEvents,e);
+  else if(fromTask) take(&taskEvents,e);
+  else return 0;
+  return 1;
+}
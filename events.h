@@ -0,0 +1,50 @@
+#ifndef events_h
+#define events_h
+/**This library passes typed, time stamped events to controlTick().  Each
+ * queue is a ring with a single producer and a single consumer, so it
+ * needs no locking: only the producer moves the head and only the
+ * consumer moves the tail, and each of them is a single byte.
+ *
+ * There are two queues.  Interrupts post to isrEvents (interrupts don't
+ * nest, so together they are one producer), and the tick functions post
+ * to taskEvents.  An interrupt must never post to taskEvents, nor a tick
+ * function to isrEvents.
+ */
+
+//The number of events each queue holds (a power of 2)
+#define EVENT_QUEUE_LENGTH 8
+
+enum eventType
+{
+  BUTTON_EVENT,   //The button was pressed
+  SHAKE_EVENT,    //The accelerometer was shaken
+  HAND_EVENT,     //A hand is warming the thermometer
+};
+
+struct event
+{
+  unsigned char type;
+  unsigned char data;
+  //The value of clockNow() when the event was posted
+  unsigned int time;
+};
+
+struct eventQueue
+{
+  event slots[EVENT_QUEUE_LENGTH];
+  volatile unsigned char head;
+  volatile unsigned char tail;
+  //Events that were posted while the queue was full
+  volatile unsigned char dropped;
+};
+
+extern eventQueue isrEvents;
+extern eventQueue taskEvents;
+
+//Adds an event to the queue.  Returns 0 if the queue was full
+int postEvent(eventQueue* queue, unsigned char type, unsigned char data);
+
+//Takes the oldest event from the two queues.  Returns 0 if both are empty
+int nextEvent(event* e);
+
+#endif
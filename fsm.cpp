@@ -0,0 +1,69 @@
+/**This library steps the table driven state machines.  All of the tables
+ * are in flash, so each row is read with pgm_read; because the rows of a
+ * state are listed together, the search stops as soon as it has passed
+ * them.
+ */
+#include "fsm.h"
+
+unsigned char fsmStep(const fsmMachine* machine, unsigned char state)
+{
+  const fsmTransition* row=(const fsmTransition*)pgm_read_word(&machine->transitions);
+  unsigned char count=pgm_read_byte(&machine->count);
+  unsigned char found=0;
+
+  for(;count;count--,row++)
+  {
+    if(pgm_read_byte(&row->from)!=state)
+    {
+      if(found) break;
+      continue;
+    }
+    found=1;
+    fsmGuard guard=(fsmGuard)pgm_read_word(&row->guard);
+    if(guard && !guard()) continue;
+    fsmAction action=(fsmAction)pgm_read_word(&row->action);
+    if(action) action();
+    state=pgm_read_byte(&row->to);
+    break;
+  }
+
+  const fsmAction* actions=(const fsmAction*)pgm_read_word(&machine->actions);
+  fsmAction action=(fsmAction)pgm_read_word(&actions[state]);
+  if(action) action();
+  return state;
+}
+
+#ifdef FSM_EXPORT
+
+static void putString(void (*put)(char), const char* s)
+  {while(*s) put(*s++);}
+
+void fsmExport(const fsmMachine* machine, void (*put)(char))
+{
+  const fsmTransition* row=(const fsmTransition*)pgm_read_word(&machine->transitions);
+  const char* const* names=(const char* const*)pgm_read_word(&machine->stateNames);
+  unsigned char count=pgm_read_byte(&machine->count);
+
+  putString(put,"digraph ");
+  putString(put,(const char*)pgm_read_word(&machine->name));
+  putString(put," {\n");
+  for(;count;count--,row++)
+  {
+    putString(put,"  ");
+    putString(put,names[pgm_read_byte(&row->from)]);
+    putString(put," -> ");
+    putString(put,names[pgm_read_byte(&row->to)]);
+    //Transitions without a guard are always taken, and are left unlabelled
+    const char* label=(const char*)pgm_read_word(&row->label);
+    if(label[0]!='0' || label[1])
+    {
+      putString(put," [label=\"");
+      putString(put,label);
+      putString(put,"\"]");
+    }
+    putString(put,";\n");
+  }
+  putString(put,"}\n");
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef fsm_h
+#define fsm_h
+/**This library runs the tick functions' state machines from tables kept in
+ * flash, in place of the pair of switch statements each of them used to
+ * have.  A machine is a list of transitions and a list of state actions:
+ *
+ *   - Each tick, the transitions out of the current state are tried in the
+ *     order they are listed.  The first whose guard returns nonzero (or
+ *     that has no guard) is taken: its action runs and the state changes.
+ *   - Then the action of the (possibly new) state runs, as the second
+ *     switch statement used to do.
+ *
+ * The transitions of each state must be listed together.  FSM_CHECK()
+ * verifies that, and that every state is in range, when compiling.
+ *
+ * Building with FSM_EXPORT defined keeps the names of states and guards,
+ * and adds fsmExport(), which writes a machine as a Graphviz graph.  The
+ * machines then have external linkage, so fsmexport.cpp can write them
+ * all (see tools/fsmgraph.py).
+ */
+#include <avr/pgmspace.h>
+
+typedef int (*fsmGuard)();
+typedef void (*fsmAction)();
+
+struct fsmTransition
+{
+  unsigned char from;
+  fsmGuard guard;
+  fsmAction action;
+  unsigned char to;
+#ifdef FSM_EXPORT
+  const char* label;
+#endif
+};
+
+struct fsmMachine
+{
+  const fsmTransition* transitions;
+  const fsmAction* actions;
+  unsigned char count;
+  unsigned char states;
+#ifdef FSM_EXPORT
+  const char* name;
+  const char* const* stateNames;
+#endif
+};
+
+//A row of a transition table: from --guard / action--> to
+#ifdef FSM_EXPORT
+#define FSM_ROW(from,guard,action,to) {from,guard,action,to,#guard}
+#else
+#define FSM_ROW(from,guard,action,to) {from,guard,action,to}
+#endif
+
+//Declares the machine "name" from the arrays name##Transitions, name##Actions
+//and, with FSM_EXPORT, name##Names (the states' names)
+#ifdef FSM_EXPORT
+#define FSM_MACHINE(name) \
+  extern const fsmMachine name##Machine; \
+  const fsmMachine name##Machine PROGMEM={name##Transitions,name##Actions, \
+    fsmLength(name##Transitions),fsmLength(name##Actions),#name,name##Names}
+#else
+#define FSM_MACHINE(name) \
+  const fsmMachine name##Machine PROGMEM={name##Transitions,name##Actions, \
+    fsmLength(name##Transitions),fsmLength(name##Actions)}
+#endif
+
+//Checks the tables of machine "name" when compiling
+#define FSM_CHECK(name) \
+  static_assert(fsmInRange(name##Transitions,fsmLength(name##Transitions),fsmLength(name##Actions)), \
+    #name ": a transition names a state with no action entry"); \
+  static_assert(fsmGrouped(name##Transitions,1,fsmLength(name##Transitions)), \
+    #name ": the transitions of a state must be listed together")
+
+template<class T, unsigned char N>
+constexpr unsigned char fsmLength(const T (&)[N])
+  {return N;}
+
+constexpr bool fsmInRange(const fsmTransition* t, unsigned char n, unsigned char states)
+  {return !n || (t[n-1].from<states && t[n-1].to<states && fsmInRange(t,n-1,states));}
+
+constexpr bool fsmSeen(const fsmTransition* t, unsigned char n, unsigned char state)
+  {return n && (t[n-1].from==state || fsmSeen(t,n-1,state));}
+
+constexpr bool fsmGrouped(const fsmTransition* t, unsigned char i, unsigned char n)
+{
+  return i>=n || ((t[i].from==t[i-1].from || !fsmSeen(t,i-1,t[i].from))
+    && fsmGrouped(t,i+1,n));
+}
+
+//Advances a machine one tick from "state", and returns the new state
+unsigned char fsmStep(const fsmMachine* machine, unsigned char state);
+
+#ifdef FSM_EXPORT
+//Writes the machine as a Graphviz digraph, one character at a time
+void fsmExport(const fsmMachine* machine, void (*put)(char));
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/**This library writes each machine with fsmExport(), straight to the UART
+ * by waiting on it.  Nothing else is set up, so no interrupt is ever
+ * enabled, and the machines' guards and actions are never run.
+ */
+#ifdef FSM_EXPORT
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "fsmexport.h"
+#include "fsm.h"
+
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
+
+//The machines, from accelerometer.cpp, control.cpp, thermometer.cpp
+//and servo.cpp
+extern const fsmMachine accelMachine;
+extern const fsmMachine controlMachine;
+extern const fsmMachine thermMachine;
+extern const fsmMachine jointMachine;
+
+static void put(char c)
+{
+  while(!(UCSR0A&(1<<UDRE0)));
+  UDR0=c;
+}
+
+void fsmExportMain()
+{
+  UCSR0A=(1<<U2X0);
+  UBRR0=(F_CPU/(8UL*FSM_EXPORT_BAUD))-1;
+  UCSR0C=(1<<UCSZ01)|(1<<UCSZ00);
+  UCSR0B=(1<<TXEN0);
+
+  fsmExport(&accelMachine,put);
+  fsmExport(&controlMachine,put);
+  fsmExport(&thermMachine,put);
+  fsmExport(&jointMachine,put);
+  for(const char* s="FSM_DONE\n";*s;s++) put(*s);
+  UCSR0A|=(1<<TXC0);
+  while(!(UCSR0A&(1<<TXC0)));
+
+  //Sleeping with interrupts off ends the simulation
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+}
+
+#endif
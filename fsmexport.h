@@ -0,0 +1,17 @@
+#ifndef fsmexport_h
+#define fsmexport_h
+/**This library writes every state machine as a Graphviz graph.  It is
+ * only built with FSM_EXPORT defined, which replaces the main loop with
+ * fsmExportMain().  The graphs are written to the UART one after another,
+ * each from its "digraph <name> {" line to its closing "}", followed by
+ * "FSM_DONE" when all have been written.  tools/fsmgraph.py runs this
+ * under a simulator and saves each graph as <name>.dot.
+ */
+
+//The UART speed of the graphs
+#define FSM_EXPORT_BAUD 9600
+
+//Writes every machine, and stops
+void fsmExportMain();
+
+#endif
@@ -0,0 +1,130 @@
+/**This library schedules the I2C transactions.  The registered ones are
+ * kept in a small table, and each pick is a scan of the table for the
+ * best transaction that is due.  The bus time each one takes is estimated
+ * once, when it is added, from its length and the bus clock.
+ */
+extern "C" {
+  #include "twi.h"
+}
+#include "i2cbus.h"
+#include "clock.h"
+
+//The bus clock twi.h chose, and the microseconds a byte (with its
+//acknowledge bit) takes at that clock
+#define I2C_SCL_HZ (F_CPU/(16+2UL*TWI_BITRATE*(1<<(2*TWI_PRESCALER))))
+#define I2C_BYTE_US (9*1000000UL/I2C_SCL_HZ)
+
+static i2cTransaction* table[I2C_MAX_TRANSACTIONS];
+static unsigned int missed;
+
+void setUpI2C()
+  {twi_init();}
+
+/**A read sends the address twice and the register once, and a write
+ * sends the address once
+ */
+static unsigned int cost(i2cTransaction* t)
+{
+  unsigned char bytes=t->length+(t->kind==I2C_READ?3:1);
+  return bytes*I2C_BYTE_US;
+}
+
+int i2cAdd(i2cTransaction* t)
+{
+  for(unsigned char i=0;i<I2C_MAX_TRANSACTIONS;i++)
+  {
+    if(table[i]) continue;
+    t->pending=1;
+    t->released=clockNow();
+    t->cost=cost(t);
+    table[i]=t;
+    return 1;
+  }
+  return 0;
+}
+
+void i2cRemove(i2cTransaction* t)
+{
+  for(unsigned char i=0;i<I2C_MAX_TRANSACTIONS;i++)
+    if(table[i]==t) table[i]=0;
+  t->pending=0;
+}
+
+unsigned char i2cRun(i2cTransaction* t)
+{
+  unsigned char result;
+  if(t->kind==I2C_WRITE)
+  {
+    result=twi_writeTo(t->address,t->data,t->length,1);
+    if(result==0) t->status=I2C_OK;
+    else if(result==2 || result==3) t->status=I2C_NACK;
+    else if(result==5) t->status=I2C_TIMEOUT;
+    else t->status=I2C_ERROR;
+  }
+  else
+  {
+    result=twi_writeTo(t->address,&t->reg,1,1);
+    if(result==2 || result==3) t->status=I2C_NACK;
+    else if(result==5) t->status=I2C_TIMEOUT;
+    else if(result) t->status=I2C_ERROR;
+    else if(twi_readFrom(t->address,t->data,t->length)<t->length) t->status=I2C_ERROR;
+    else t->status=I2C_OK;
+  }
+  if(t->onDone) t->onDone(t);
+  return t->status;
+}
+
+/**Returns 1 if t should run before "best"
+ */
+static int before(i2cTransaction* t, i2cTransaction* best)
+{
+  if(!best || t->priority>best->priority) return 1;
+  if(t->priority<best->priority) return 0;
+  return (int)(t->released+t->deadline-best->released-best->deadline)<0;
+}
+
+/**Returns the slot of the transaction to run next, or -1 if none is due
+ */
+static signed char pick(unsigned int now)
+{
+  signed char best=-1;
+  for(unsigned char i=0;i<I2C_MAX_TRANSACTIONS;i++)
+  {
+    i2cTransaction* t=table[i];
+    if(!t || !t->pending || (int)(now-t->released)<0) continue;
+    if(before(t,best<0?0:table[best])) best=i;
+  }
+  return best;
+}
+
+void i2cService()
+{
+  unsigned int budget=I2C_SERVICE_US;
+  unsigned int now=clockNow();
+  signed char i;
+  while((i=pick(now))>=0)
+  {
+    i2cTransaction* t=table[i];
+    //Always run one, so a long transaction still gets the bus
+    if(t->cost>budget && budget<I2C_SERVICE_US) break;
+    budget=t->cost>budget?0:budget-t->cost;
+
+    //A one-shot is finished with before it runs, so its callback may
+    //add it again
+    unsigned int due=t->released+t->deadline;
+    if(!t->period) i2cRemove(t);
+    i2cRun(t);
+    now=clockNow();
+    if((int)(now-due)>0) missed++;
+
+    if(t->period)
+    {
+      //Keep to the period, unless the bus has fallen a whole period behind
+      t->released+=t->period;
+      if((int)(now-t->released)>=(int)t->period) t->released=now;
+    }
+  }
+}
+
+unsigned int i2cMissed()
+  {return missed;}
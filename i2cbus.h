@@ -0,0 +1,80 @@
+#ifndef i2cbus_h
+#define i2cbus_h
+/**This library owns the I2C bus.  Each device on the bus describes its
+ * reads and writes as transactions and registers them here, either to be
+ * run every "period" milliseconds or once.  Every tick, i2cService() runs
+ * the transactions that are due back to back, the highest priority first
+ * and, among equal priorities, the one whose deadline is soonest, until
+ * the tick's share of bus time is used up.  Transactions that don't fit
+ * wait for the next tick, ahead of anything of lower priority.
+ *
+ * Data goes straight between the bus and the device's own buffer.
+ */
+
+//The most transactions (periodic and waiting one-shots) registered at once
+#define I2C_MAX_TRANSACTIONS 8
+
+//The bus time i2cService() may spend in one tick, in microseconds
+#define I2C_SERVICE_US 4000
+
+//Priorities.  Latency critical reads should be I2C_PRIORITY_CRITICAL
+#define I2C_PRIORITY_BACKGROUND 0
+#define I2C_PRIORITY_NORMAL 1
+#define I2C_PRIORITY_CRITICAL 2
+
+//What a transaction does
+#define I2C_READ 0
+#define I2C_WRITE 1
+
+//The outcome of the last run of a transaction
+#define I2C_OK 0
+#define I2C_NACK 1
+#define I2C_TIMEOUT 2
+#define I2C_ERROR 3
+
+struct i2cTransaction
+{
+  //Filled in by the device
+  unsigned char address;
+  //A read writes this register address, then reads "length" bytes from
+  //it.  A write sends "length" bytes of data, the first being the register
+  unsigned char reg;
+  unsigned char kind;
+  unsigned char priority;
+  unsigned char* data;
+  unsigned char length;
+  //Milliseconds between runs, or 0 to run once
+  unsigned int period;
+  //Milliseconds after it falls due that it must have run by
+  unsigned int deadline;
+  //Called after each run (may be 0)
+  void (*onDone)(i2cTransaction* t);
+
+  //Kept by the bus manager
+  unsigned char status;
+  unsigned char pending;
+  unsigned int released;
+  unsigned int cost;
+};
+
+//Configure the bus.  Call before any device is set up
+void setUpI2C();
+
+//Registers a transaction, to run from the next i2cService().
+//Returns 0 if there is no room for it
+int i2cAdd(i2cTransaction* t);
+
+//Unregisters a transaction
+void i2cRemove(i2cTransaction* t);
+
+//Runs a transaction at once, waiting for it to finish, and returns its
+//status.  For setting devices up, before the ticks start
+unsigned char i2cRun(i2cTransaction* t);
+
+//Runs the transactions that are due.  Call once at the start of each tick
+void i2cService();
+
+//Returns how many runs have finished after their deadlines
+unsigned int i2cMissed();
+
+#endif
@@ -0,0 +1,53 @@
+/**This library moves the spine with the loudness of the audio.  The
+ * envelope is an 8.8 fixed point number that rises quickly and falls
+ * slowly, and it is mapped straight onto the spine's target, so the
+ * whole tick is a handful of shifts and one 8x8 multiply.
+ */
+#include "lipsync.h"
+#include "servo.h"
+#include "voice.h"
+#ifdef VOICE_PCM
+#include "audio.h"
+#else
+#include "analog.h"
+#endif
+
+static unsigned int level;
+
+unsigned char envelope()
+  {return level>>8;}
+
+/**Returns the loudness since the last tick, 0-255
+ */
+static unsigned char loudness()
+{
+#ifdef VOICE_PCM
+  //The peak swing away from silence, scaled up from 0-AUDIO_SILENCE
+  unsigned int swing=(unsigned int)audioPeak()*(256/AUDIO_SILENCE);
+  return swing>255?255:swing;
+#else
+  //The envelope detector is read as a 10 bit number
+  return analogRead(ANALOG_SPEAKER)>>2;
+#endif
+}
+
+void lipSyncTick()
+{
+  static unsigned char talking=0;
+  unsigned int in=(unsigned int)loudness()<<8;
+
+  if(in>level) level+=(in-level)>>LIPSYNC_ATTACK_SHIFT;
+  else level-=(level-in)>>LIPSYNC_RELEASE_SHIFT;
+
+  if(voicePlaying())
+  {
+    setSpineTarget(LIPSYNC_CLOSED+((envelope()*LIPSYNC_RANGE)>>8));
+    talking=1;
+  }
+  else if(talking)
+  {
+    //Close the mouth once the sound is over
+    setSpineTarget(LIPSYNC_CLOSED);
+    talking=0;
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef lipsync_h
+#define lipsync_h
+/**This library moves the spine with the loudness of whatever is playing,
+ * so Mickey looks like he is talking.  With the ADPCM engine the loudness
+ * is taken from the decoded samples; with the soundFX board it is read
+ * from an envelope detector (a diode and RC) on the board's output,
+ * connected to ADC6.
+ */
+
+//The spine angle at silence, and how far it swings at full loudness
+#define LIPSYNC_CLOSED 90
+#define LIPSYNC_RANGE 40
+
+//How quickly the envelope follows rising and falling loudness.  Each tick
+//it moves 1/2^shift of the way to the new level
+#define LIPSYNC_ATTACK_SHIFT 1
+#define LIPSYNC_RELEASE_SHIFT 3
+
+//Returns the envelope of the audio, 0-255
+unsigned char envelope();
+
+//Advances the envelope one tick, and while a sound plays sets the spine
+//target from it.  Call after controlTick() and before servoTick()
+void lipSyncTick();
+
+#endif
@@ -1,20 +1,85 @@
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "servo.h"
+#include "analog.h"
 #include "thermometer.h"
 #include "voice.h"
 #include "button.h"
 #include "accelerometer.h"
 #include "control.h"
+#include "lipsync.h"
+#include "events.h"
+#include "clock.h"
+#include "i2cbus.h"
+#include "settings.h"
+#include "boot.h"
+#ifdef BENCH
+#include "bench.h"
+#endif
+#ifdef FSM_EXPORT
+#include "fsmexport.h"
+#endif
+#include "prng.h"
+#ifdef ASSET_STORE
+#include "assets.h"
+#endif
 
-//The interrupt will function based on timer 0.void interruptSetUp()
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
+
+#ifdef VOICE_PCM
+#include "audio.h"
+//Timer 0 also clocks the audio, so it overflows once per sample
+#define TIMER0_HZ AUDIO_SAMPLE_RATE
+#if AUDIO_PRESCALER==1
+#define TIMER0_PRESCALE (1<<CS00)
+#else
+#define TIMER0_PRESCALE (1<<CS01)
+#endif
+#define TIMER0_TOP AUDIO_TOP
+#else
+//Without audio Timer 0 only needs to overflow 1000 times per second
+#define TIMER0_HZ 1000
+#define TIMER0_PRESCALE (1<<CS01)
+#define TIMER0_TOP (F_CPU/8/TIMER0_HZ-1)
+#endif
+
+//The microseconds in one overflow of Timer 0
+#define TIMER0_US (1000/(TIMER0_HZ/1000))
+
+//Timer 0 overflows a whole number of times per millisecond
+#define OVERFLOWS_PER_MS (TIMER0_HZ/1000)
+#if TIMER0_HZ%1000
+#error "Timer 0 must overflow a whole number of times per millisecond"
+#endif
+
+//The state machines tick about 60 times per second
+#define TICK_HZ 60
+#define TICK_MS (1000/TICK_HZ)
+
+//The most ticks that are caught up when the loop falls behind.  Any more
+//are dropped, so a long stall doesn't become a burst of ticks
+#define TICK_MAX_BEHIND 4
+
+//The interrupt will function based on timer 0.
 void interruptSetUp()
 {
-  //Clear the timer settings
-  TCCR0A=0;
+  //Clear the timer settings, except for any output compare pin
+  //that setUpAudio() has enabled if it has already run
+  TCCR0A&=(1<<COM0B1)|(1<<COM0B0);
   TCCR0B=0;
-  
-  //Enable timer.  This prescaler will cause it to tick about 32 times per second
-  TCCR0B |= (1<<CS01)|(1<<CS00);
+
+  //Fast PWM with OCR0A as TOP (mode 7), so the overflow period can be
+  //set exactly, as it could in CTC mode.  Unlike CTC, this also lets
+  //output B play audio
+  TCCR0A|=(1<<WGM01)|(1<<WGM00);
+  TCCR0B|=(1<<WGM02);
+  OCR0A=TIMER0_TOP;
+
+  //Enable timer.
+  TCCR0B|=TIMER0_PRESCALE;
   
   //Enable interupts globally
   SREG |= (1<<7);
@@ -23,54 +88,118 @@ void interruptSetUp()
   TIMSK0 |= (1<<TOIE0);
 }
 
-//This is the ISR function for the timer input
-int readyToTick;
+//This is the ISR function for the timer input.  It plays the next audio
+//sample, advances the millisecond clock, and counts out the ticks from it
+volatile unsigned char ticksDue;
+static volatile unsigned char overflows;
 ISR(TIMER0_OVF_vect)
 {
-/**  static int t=0;
-  t++;
-  if(t>)
+#ifdef VOICE_PCM
+  audioSample();
+#endif
+#if OVERFLOWS_PER_MS>1
+  if(++overflows<OVERFLOWS_PER_MS) return;
+  overflows=0;
+#endif
+  clockMs++;
+  static unsigned char ms=0;
+  if(++ms>=TICK_MS)
+  {
+    ms=0;
+    if(ticksDue<TICK_MAX_BEHIND) ticksDue++;
+  }
+}
+
+unsigned long bootTimes[BOOT_PHASES];
+static unsigned char bootMarked;
+
+/**The time is the clock's milliseconds, plus the overflows and the count
+ * of Timer 0 since the last millisecond.  An overflow that is waiting for
+ * the interrupt has already wrapped the count, so it is added in too
+ */
+void bootMark(unsigned char phase)
+{
+  if(bootMarked&(1<<phase)) return;
+  bootMarked|=1<<phase;
+  unsigned long ms;
+  unsigned char parts;
+  unsigned char count;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    readyToTick=1;
-    t=0;
-  }*/
-  readyToTick=1;
+    ms=clockMs;
+    parts=overflows;
+    count=TCNT0;
+    if((TIFR0&(1<<TOV0)) && count<TIMER0_TOP) parts++;
+  }
+  bootTimes[phase]=ms*1000+parts*TIMER0_US+(unsigned long)count*TIMER0_US/(TIMER0_TOP+1);
 }
 
+/**The clock starts first, so every phase can be timed.  Nothing here
+ * waits on a device: the servos drive home on their own, and the IMU is
+ * woken and configured by the bus manager on the first ticks, so both
+ * carry on while the rest is set up.  Calibration is left to the
+ * accelerometer's state machine, which does it on an idle tick.
+ */
 void mySetup()
 {
+  interruptSetUp();
+  bootMark(BOOT_CLOCK);
+  //The stored calibration and tuning are needed by the rest of setup
+  loadSettings();
   configurePWM1();
   configurePWM2();
-  setUpTemperature();
+  bootMark(BOOT_SERVOS);
+  setUpI2C();
+  setUpAccel();
+  bootMark(BOOT_IMU);
+#ifdef ASSET_STORE
+  //The flash's chip select shares port B with the servos
+  setUpAssets();
+#endif
+  //The seed is taken from the ADC before the scanner takes it over
+  seedRandom();
+  setUpAnalog();
   setUpButton();
   setUpVoice();
-  setUpAccel();
-  interruptSetUp();
+  bootMark(BOOT_PERIPHERALS);
+  //Greet, now that the voice is ready to play it
+  enableAccelerometerSound();
+  bootMark(BOOT_READY);
 }
 
 void myLoop()
 {
  static int s=0;
- if(readyToTick)
+ //A tick that was missed while the last one ran long is run at once
+ if(ticksDue)
   {
+    analogLatch();
 //Enable the temperature sound to test speakers
 //    enableTemperatureSound();
-    buttonTick();
+    //The sensors are read first, so the state machines see fresh samples
+    i2cService();
     accelTick();
     controlTick();
-    if(accelerating()) enableAccelerometerSound();
-    else disableAudio();
+    voiceTick();
+    lipSyncTick();
     thermTick();
-    servoTick();
-    readyToTick=0;
+    settingsTick();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ticksDue--;}
   }
+ //The servos move once per PWM frame, just after the last move was sent
+ if(servoFrame()) servoTick();
 }
 
 
 
 
 int main(){
-  enableAccelerometerSound();
+#ifdef FSM_EXPORT
+  fsmExportMain();
+#endif
+#ifdef BENCH
+  benchMain();
+#endif
   mySetup();
   while(true){myLoop();}
   return 0;
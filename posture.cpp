@@ -0,0 +1,122 @@
+/**This library runs the complementary filter in integer arithmetic only.
+ * The angles of gravity come from an arctangent table.  The only divisions
+ * are the two 16 bit ones that find the table entries, one for roll and
+ * one for pitch, so a sample takes about the same time whatever the
+ * readings are.
+ */
+#include <avr/pgmspace.h>
+#include "posture.h"
+#include "clock.h"
+
+#define POSTURE_QUARTER 0x4000U
+#define POSTURE_HALF 0x8000U
+
+//The gyroscope gives 131 per degree per second.  Over a millisecond that
+//is 65536/(360*131*1000) of a binary angle for each unit of rate, which is
+//GYRO_SCALE/2^GYRO_SHIFT
+#define GYRO_SHIFT 16
+#define GYRO_SCALE ((16384UL<<GYRO_SHIFT)/(90UL*131*1000))
+
+//The longest time between samples the gyroscope is trusted over.  A
+//longer gap, such as a stalled bus, is taken as this long
+#define GYRO_MAX_MS (4*POSTURE_PERIOD_MS)
+
+//atan(i/32) for i=0..32, as binary angles
+static const unsigned int atanTable[33] PROGMEM=
+{
+  0,326,651,975,1297,1617,1933,2246,2555,2860,3159,
+  3453,3742,4025,4302,4572,4836,5094,5344,5589,5826,6058,
+  6282,6500,6712,6917,7117,7310,7498,7679,7856,8026,8192
+};
+
+static int pitch;
+static int roll;
+static unsigned char primed;
+static unsigned int lastSample;
+
+/**Returns the angle of the vector (x,y) as a binary angle.  Both must be
+ * within +/-255.  The angle is found for the first octant, from the table
+ * with linear interpolation between entries, and then reflected into place
+ */
+static int atan2Binary(int y, int x)
+{
+  unsigned int ay=y<0?-y:y;
+  unsigned int ax=x<0?-x:x;
+  if(!ax && !ay) return 0;
+  unsigned int lo=ay<ax?ay:ax;
+  unsigned int hi=ay<ax?ax:ay;
+
+  //The ratio of the smaller to the larger, from 0 to 256
+  unsigned int ratio=(lo<<8)/hi;
+  unsigned char i=ratio>>3;
+  unsigned char fraction=ratio&7;
+  unsigned int angle=pgm_read_word(&atanTable[i]);
+  if(fraction) angle+=((pgm_read_word(&atanTable[i+1])-angle)*fraction)>>3;
+
+  if(ay>ax) angle=POSTURE_QUARTER-angle;
+  if(x<0) angle=POSTURE_HALF-angle;
+  if(y<0) angle=-angle;
+  return (int)angle;
+}
+
+/**Moves an angle by the turn measured over the "ms" since the last
+ * sample, then pulls it toward the accelerometer's angle.  The difference
+ * wraps, so the pull always takes the short way round
+ */
+static int blend(int angle, int rate, unsigned char ms, int measured)
+{
+  angle+=(int)(((long)rate*ms*GYRO_SCALE)>>GYRO_SHIFT);
+  int error=(int)((unsigned int)measured-(unsigned int)angle);
+  return angle+(error>>POSTURE_BLEND_SHIFT);
+}
+
+void postureSample(signed char ax, signed char ay, signed char az, int gx, int gy)
+{
+  //Roll is the angle of gravity about the x axis.  Pitch is its angle out
+  //of the y-z plane, whose length is estimated as the larger of the two
+  //plus 3/8 of the smaller, so no square root is needed
+  int measuredRoll=atan2Binary(ay,az);
+  unsigned char y=ay<0?-ay:ay;
+  unsigned char z=az<0?-az:az;
+  int across=y>z?y+((3*z)>>3):z+((3*y)>>3);
+  int measuredPitch=atan2Binary(-ax,across);
+
+  //The samples are timed, rather than taken to be POSTURE_PERIOD_MS apart,
+  //so a late or dropped read still turns the angles the right amount
+  unsigned int now=clockNow();
+  unsigned int elapsed=now-lastSample;
+  lastSample=now;
+  if(elapsed>GYRO_MAX_MS) elapsed=GYRO_MAX_MS;
+
+  if(!primed)
+  {
+    pitch=measuredPitch;
+    roll=measuredRoll;
+    primed=1;
+    return;
+  }
+  roll=blend(roll,gx,elapsed,measuredRoll);
+  pitch=blend(pitch,gy,elapsed,measuredPitch);
+}
+
+int posturePitch()
+  {return pitch;}
+
+int postureRoll()
+  {return roll;}
+
+/**Lying on the face or back is judged on the pitch first.  Then gravity
+ * is nearly along the x axis, so the roll, its angle about that axis, is
+ * only noise.  Otherwise the roll tells upside down, which the pitch
+ * can't tell from upright, and on the side
+ */
+unsigned char posture()
+{
+  if(pitch>=POSTURE_LYING) return POSTURE_FACE_DOWN;
+  if(pitch<=-POSTURE_LYING) return POSTURE_FACE_UP;
+  if(roll==(int)POSTURE_HALF) return POSTURE_UPSIDE_DOWN;
+  int absRoll=roll<0?-roll:roll;
+  if(absRoll>=POSTURE_INVERTED) return POSTURE_UPSIDE_DOWN;
+  if(absRoll>=POSTURE_LYING) return POSTURE_ON_SIDE;
+  return POSTURE_UPRIGHT;
+}
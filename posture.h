@@ -0,0 +1,53 @@
+#ifndef posture_h
+#define posture_h
+/**This library estimates which way up the robot is.  The accelerometer
+ * gives the direction of gravity, which is right on average but shaken
+ * about by every movement, and the gyroscope gives the rate of turn, which
+ * is smooth but drifts.  A complementary filter follows the gyroscope from
+ * sample to sample and pulls slowly toward the accelerometer's angle, so it
+ * has the good half of each.
+ *
+ * Angles are binary: a whole turn is 65536, so they wrap around in an int
+ * just as they do in the world.  Pitch is positive leaning forward, onto
+ * the face, and roll is positive leaning to the right.  The GY-521 is
+ * assumed to lie flat with its x axis forward when the robot stands upright.
+ */
+
+//Converts degrees to a binary angle
+#define POSTURE_DEGREES(d) ((int)((d)*65536L/360))
+
+//The milliseconds between samples.  The axes are read once per tick.
+//The filter times each sample itself, so this only sets the read rate
+#define POSTURE_PERIOD_MS 16
+
+//The accelerometer's angle is given 1/2^POSTURE_BLEND_SHIFT of the weight
+//on each sample, so the filter follows it with a time constant of about
+//2^POSTURE_BLEND_SHIFT samples (half a second)
+#define POSTURE_BLEND_SHIFT 5
+
+//How far the robot must lean before it is taken to be lying down, and
+//how far it must roll before it is taken to be upside down
+#define POSTURE_LYING POSTURE_DEGREES(60)
+#define POSTURE_INVERTED POSTURE_DEGREES(120)
+
+//The postures posture() tells apart
+#define POSTURE_UPRIGHT 0
+#define POSTURE_FACE_DOWN 1
+#define POSTURE_FACE_UP 2
+#define POSTURE_ON_SIDE 3
+#define POSTURE_UPSIDE_DOWN 4
+#define POSTURES 5
+
+//Feeds the filter one sample.  The accelerations are the high bytes of the
+//axes at +/-2g, and the rates the whole readings at +/-250 degrees per
+//second.  Called by the accelerometer after each good burst
+void postureSample(signed char ax, signed char ay, signed char az, int gx, int gy);
+
+//Returns the filtered pitch and roll, as binary angles
+int posturePitch();
+int postureRoll();
+
+//Returns the posture the angles fall in
+unsigned char posture();
+
+#endif
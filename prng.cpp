@@ -0,0 +1,60 @@
+/**This library is a 16 bit xorshift pseudorandom number generator.  The
+ * shifts (7, 9, 8) give the full period of 65535 for any nonzero state.
+ */
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "prng.h"
+
+//16 bits wide on any compiler, so tools/test_prng.py runs this same
+//generator on the host
+static uint16_t state=1;
+
+/**Folds the low bits of PRNG_SEED_SAMPLES conversions into the state.  The
+ * ADC is run with its smallest prescaler, far faster than it is accurate,
+ * so the low bits are mostly noise
+ */
+void seedRandom()
+{
+  unsigned int seed=0;
+  ADMUX=(1<<REFS0)|PRNG_SEED_MUX;
+  ADCSRA=(1<<ADEN)|(1<<ADPS0);
+  for(unsigned char i=0;i<PRNG_SEED_SAMPLES;i++)
+  {
+    ADCSRA|=(1<<ADSC);
+    while(ADCSRA&(1<<ADSC));
+    seed=(seed<<3|seed>>13)^ADC;
+  }
+  ADCSRA=0;
+  //The one state the generator can never leave
+  if(seed) state=seed;
+}
+
+unsigned int randomWord()
+{
+  state^=state<<7;
+  state^=state>>9;
+  state^=state<<8;
+  return state;
+}
+
+unsigned char randomByte()
+  {return randomWord()>>8;}
+
+/**Scales a random byte to the total of the weights with a multiply and a
+ * shift, then walks the weights to find which choice it fell in
+ */
+unsigned char randomChoice(const unsigned char* weights, unsigned char n)
+{
+  unsigned char total=0;
+  for(unsigned char i=0;i<n;i++) total+=pgm_read_byte(&weights[i]);
+
+  unsigned char r=((unsigned int)randomByte()*total)>>8;
+  for(unsigned char i=0;i<n-1;i++)
+  {
+    unsigned char weight=pgm_read_byte(&weights[i]);
+    if(r<weight) return i;
+    r-=weight;
+  }
+  return n-1;
+}
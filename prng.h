@@ -0,0 +1,29 @@
+#ifndef prng_h
+#define prng_h
+/**This library is a small pseudorandom number generator for choosing
+ * poses and behaviours.  It is a 16 bit xorshift generator, which needs
+ * only shifts and exclusive ors, seeded from the noise in a few fast ADC
+ * conversions so that each power up behaves differently.
+ */
+
+//The ADC channel sampled for the seed (the microphone), and how many
+//conversions are folded into it
+#define PRNG_SEED_MUX 0
+#define PRNG_SEED_SAMPLES 32
+
+//Seed the generator.  This takes over the ADC, so call it before
+//setUpAnalog()
+void seedRandom();
+
+//Returns the next pseudorandom number, 1-65535
+unsigned int randomWord();
+
+//Returns a pseudorandom number, 0-255
+unsigned char randomByte();
+
+//Picks one of n choices, choice i being picked with probability
+//weights[i]/(sum of the weights).  "weights" must be in program memory,
+//and may sum to at most 255
+unsigned char randomChoice(const unsigned char* weights, unsigned char n);
+
+#endif
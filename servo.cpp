@@ -1,22 +1,75 @@
 /**This library is written to interface with three servos using PWM.  Two servos
  * are controlled using Timer 1, and their PWM inputs should be connected to
  * output A and output B respectively.  The third servo should be connected to 
- * Timer 2's output A. 
+ * Timer 2's output B (pin D3), which leaves Timer 2's output A pin free to
+ * be the SPI bus's MOSI. 
  */
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "servo.h"
+#include "analog.h"
+#include "fsm.h"
+#include "settings.h"
 
 #define MAX_TIMER1 20000 //This gives a frequency of 50Hz
 
-/**Read the position of the right shoulder.  OCR1A is the register
- * that stores the pulse width for the PWM on Timer 1's output A.
- * The (0CR1A-410)/11 portion converts that PWM to an degree measurement
+//The frames a joint holds still before it is detached
+#define SERVO_HOLD_FRAMES (SERVO_HOLD_MS/20)
+static_assert(SERVO_HOLD_FRAMES<=255,"SERVO_HOLD_MS is too long to count in a byte");
+
+/**The compare values are staged here by the set functions, and copied to
+ * the compare registers together by the Timer 1 overflow interrupt, at
+ * the top of each 20ms frame.  So all three servos change in the same
+ * frame, and a 16 bit register is never written from the main loop while
+ * an interrupt might be using the timer's shared high byte register.
+ */
+static volatile unsigned int rightPulse;
+static volatile unsigned int leftPulse;
+static volatile unsigned char spinePulse;
+
+//Set by the interrupt at each frame, cleared by servoFrame()
+static volatile unsigned char framePending;
+static volatile unsigned char overruns;
+
+ISR(TIMER1_OVF_vect)
+{
+  OCR1A=rightPulse;
+  OCR1B=leftPulse;
+  OCR2B=spinePulse;
+  if(framePending) overruns++;
+  framePending=1;
+}
+
+/**The flag is tested and cleared with the interrupt held off, so a
+ * frame that starts in between is neither lost nor counted as an overrun
+ */
+int servoFrame()
+{
+  int pending;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    pending=framePending;
+    framePending=0;
+  }
+  return pending;
+}
+
+unsigned char servoOverruns()
+  {return overruns;}
+
+/**The positions are given without the trims, which are only added to
+ * the pulses, so the trims move the horns but nothing else sees them.
+ *
+ * Read the position of the right shoulder.  rightPulse is the staged
+ * pulse width for the PWM on Timer 1's output A.
+ * The (rightPulse-410)/11 portion converts that PWM to an degree measurement
  * in the Servo's angle-space.  Subtracting this from 180 converts it so
  * that the angular position is consistent with the other shoulder servo,
  * even though they are facing different directions.
  */
 int positionRightShoulder()
-  {return 180-(OCR1A-410)/11;}
+  {return 180-(rightPulse-410)/11-settings.trim[SERVO_RIGHT];}
 
 /**To stay within the bounds of natural motion for the Mickey plush,
  * first ensure that the indicated position will be between 45 and
@@ -29,17 +82,18 @@ void setRightShoulder(int pos)
 {
   if(pos<45) pos=45;
   if(pos>135) pos=135;
-  OCR1A=410+11*(180-pos);
+  pos+=settings.trim[SERVO_RIGHT];
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){rightPulse=410+11*(180-pos);}
 }
 
 
-/**Read the position of the right shoulder.  OCR1A is the register
- * that stores the pulse width for the PWM on Timer 1's output A.
- * The (0CR1A-400)/11 portion converts that PWM to an degree measurement
+/**Read the position of the left shoulder.  leftPulse is the staged
+ * pulse width for the PWM on Timer 1's output B.
+ * The (leftPulse-400)/11 portion converts that PWM to an degree measurement
  * in the Servo's angle-space.
  */
 int positionLeftShoulder()
-  {return (OCR1B-400)/11;}
+  {return (leftPulse-400)/11-settings.trim[SERVO_LEFT];}
   
 /**To stay within the bounds of natural motion for the Mickey plush,
  * first ensure that the indicated position will be between 45 and
@@ -52,7 +106,8 @@ void setLeftShoulder(int pos)
 {
   if(pos<45) pos=45;
   if(pos>135) pos=135;
-  OCR1B=400+11*pos;
+  pos+=settings.trim[SERVO_LEFT];
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){leftPulse=400+11*pos;}
 }
 
 /**This function carries out integer division, but the quotient will
@@ -91,7 +146,8 @@ int positionSpine()
   spineAngle=pos;
   if(pos<45) pos=45;
   if(pos>135) pos=135;
-  OCR2A=10+roundIntDivision(pos,6);
+  pos+=settings.trim[SERVO_SPINE];
+  spinePulse=10+roundIntDivision(pos,6);
 }
 
 /**This configures Timer 1 for PWM output on both the A and B outputs
@@ -125,10 +181,14 @@ void configurePWM1()
   //Set both angles to 90 degrees as a default position
   setLeftShoulder(90);
   setRightShoulder(90);
+  OCR1A=rightPulse;
+  OCR1B=leftPulse;
 
+  //Commit the staged pulses at the top of every frame
+  TIMSK1 |= (1<<TOIE1);
 }
 
-/**This configures Timer 2 for PWM output on the A output
+/**This configures Timer 2 for PWM output on the B output
  */
 void configurePWM2()
 {
@@ -136,18 +196,19 @@ void configurePWM2()
   TCCR2A=0;
   TCCR2B=0;  
   // set PWM for 50% duty cycle
-  TCCR2A |= (1 << COM2A1);
+  TCCR2A |= (1 << COM2B1);
 
   // set none-inverting mode
   TCCR2A |= (1 << WGM21) | (1 << WGM20);
   // set fast PWM Mode
   TCCR2B |= (1 << CS22);
   // set prescaler to 8 and starts PWM
-  //Set OC2A as output
-  DDRB |= 0x08;
+  //Set OC2B as output
+  DDRD |= 0x08;
 
   //Set both angles to 90 degrees as a default position
   setSpine(spineAngle);
+  OCR2B=spinePulse;
 }
 
 void configurePWM()
@@ -161,173 +222,235 @@ void configurePWM()
 
 
 
-enum state_SPINE {init_SPINE, moveLeft_SPINE, moveRight_SPINE, holdStill_SPINE};
-int spineTarget;
-void setSpineTarget(int target){spineTarget=target;}
-int spineAtTarget(){return spineTarget==positionSpine();}
+/**The power budget.  Starting a servo draws far more current than keeping
+ * it moving, so each joint ramps its step up from 1 degree per frame to the
+ * step limit, and only SERVO_MAX_ACCELERATING joints may be ramping at
+ * once.  Move starts are also staggered by SERVO_STAGGER_FRAMES.  While the
+ * supply is below SERVO_SUPPLY_LOW_MV the step limit backs off by one
+ * degree each frame and only one joint may ramp; once the supply recovers
+ * the limit climbs back to SERVO_MAX_STEP just as quickly.
+ */
+static int stepLimit=SERVO_MAX_STEP;
+static int ramping;
+static int staggerCount=SERVO_STAGGER_FRAMES;
+
+static int supplyLow()
+  {return analogRead(ANALOG_SUPPLY)>SUPPLY_READING(SERVO_SUPPLY_LOW_MV);}
+
+static int isRamping(int step)
+  {return step>0 && step<stepLimit;}
+
+/**Returns 1 and claims a place in the budget if a joint may start
+ * moving this frame, 0 if it must keep waiting
+ */
+static int servoStart()
+{
+  int maxRamping=supplyLow()?1:SERVO_MAX_ACCELERATING;
+  if(ramping>=maxRamping || staggerCount<SERVO_STAGGER_FRAMES) return 0;
+  ramping++;
+  staggerCount=0;
+  return 1;
+}
 
-void moveSpine()
+/**Returns the step for this frame of a joint that moved by "step"
+ * degrees last frame
+ */
+static int rampStep(int step)
 {
-  static state_SPINE state=init_SPINE;
-  switch(state)
-  {
-    case init_SPINE:
-      spineTarget=90;
-      state= holdStill_SPINE;
-      break;
-    case moveLeft_SPINE:
-      if(spineTarget>positionSpine()) state=moveLeft_SPINE;
-      else if(spineTarget<positionSpine()) state=moveRight_SPINE;
-      else state=holdStill_SPINE;
-      break;
-    case moveRight_SPINE:
-      if(spineTarget>positionSpine()) state=moveLeft_SPINE;
-      else if(spineTarget<positionSpine()) state=moveRight_SPINE;
-      else state=holdStill_SPINE;
-      break;
-    case holdStill_SPINE:
-      if(spineTarget>positionSpine()) state=moveLeft_SPINE;
-      else if(spineTarget<positionSpine()) state=moveRight_SPINE;
-      else state=holdStill_SPINE;
-      break;
-    default:
-      state=init_SPINE;
-      break;
-  }
+  if(step<stepLimit) return step+1;
+  return stepLimit;
+}
+
+
+/**Detaching a joint disconnects its pin from the timer, and the pin's
+ * port bit, which is low, takes over.  That is only done between two
+ * pulses, with the pin low and the timer clear of the next pulse's start,
+ * so the last pulse is never cut short.  The timer's own output latch was
+ * cleared by that pulse, and is left alone while disconnected, so when the
+ * pin is connected again it stays low until the next frame begins a whole
+ * pulse.  Neither change can make a short pulse.
+ */
+#define RIGHT_PIN 0x02
+#define LEFT_PIN 0x04
+#define SPINE_PIN 0x08
+
+//Timer 2 counts every 64 cycles
+#define TIMER2_MARGIN (SERVO_DETACH_MARGIN_US/64+1)
 
-  switch(state)
+static int detachRight()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    case init_SPINE:
-      break;
-    case moveLeft_SPINE:
-        if(spineTarget-positionSpine()<4) setSpine(spineTarget);
-        else setSpine(positionSpine()-4);
-        break;
-    case moveRight_SPINE:
-        if(positionSpine()-spineTarget<4) setSpine(spineTarget);
-        else setSpine(positionSpine()+4);
-        break;
-    case holdStill_SPINE:
-      break;
-    default:
-      break;
+    if((PINB&RIGHT_PIN) || TCNT1>MAX_TIMER1-SERVO_DETACH_MARGIN_US) return 0;
+    PORTB&=~RIGHT_PIN;
+    TCCR1A&=~(1<<COM1A1);
   }
+  return 1;
 }
 
-
-enum state_LEFT {init_LEFT, moveUp_LEFT, moveDown_LEFT, holdStill_LEFT};
-int leftTarget;
-void setLeftTarget(int target){leftTarget=target;}
-int leftAtTarget(){return leftTarget==positionLeftShoulder();}
-void moveLeft()
+static int detachLeft()
 {
-  static state_LEFT state=init_LEFT;
-  switch(state)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    case init_LEFT:
-      leftTarget=90;
-      state= holdStill_LEFT;
-      break;
-    case moveUp_LEFT:
-      if(leftTarget>positionLeftShoulder()) state=moveUp_LEFT;
-      else if(leftTarget<positionLeftShoulder()) state=moveDown_LEFT;
-      else state=holdStill_LEFT;
-      break;
-    case moveDown_LEFT:
-      if(leftTarget>positionLeftShoulder()) state=moveUp_LEFT;
-      else if(leftTarget<positionLeftShoulder()) state=moveDown_LEFT;
-      else state=holdStill_LEFT;
-      break;
-    case holdStill_LEFT:
-      if(leftTarget>positionLeftShoulder()) state=moveUp_LEFT;
-      else if(leftTarget<positionLeftShoulder()) state=moveDown_LEFT;
-      else state=holdStill_LEFT;
-      break;
-    default:
-      state=init_LEFT;
-      break;
+    if((PINB&LEFT_PIN) || TCNT1>MAX_TIMER1-SERVO_DETACH_MARGIN_US) return 0;
+    PORTB&=~LEFT_PIN;
+    TCCR1A&=~(1<<COM1B1);
   }
+  return 1;
+}
 
-  switch(state)
+static int detachSpine()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    case init_LEFT:
-      break;
-    case moveUp_LEFT:
-        if(leftTarget-positionLeftShoulder()<4) setLeftShoulder(leftTarget);
-        else setLeftShoulder(positionLeftShoulder()-4);
-        break;
-    case moveDown_LEFT:
-        if(positionLeftShoulder()-leftTarget<4) setLeftShoulder(leftTarget);
-        else setLeftShoulder(positionLeftShoulder()+4);
-        break;
-    case holdStill_LEFT:
-      break;
-    default:
-      break;
+    if((PIND&SPINE_PIN) || TCNT2>255-TIMER2_MARGIN) return 0;
+    PORTD&=~SPINE_PIN;
+    TCCR2A&=~(1<<COM2B1);
   }
+  return 1;
 }
 
+static void attachRight()
+  {ATOMIC_BLOCK(ATOMIC_RESTORESTATE){TCCR1A|=(1<<COM1A1);}}
+
+static void attachLeft()
+  {ATOMIC_BLOCK(ATOMIC_RESTORESTATE){TCCR1A|=(1<<COM1B1);}}
 
+static void attachSpine()
+  {ATOMIC_BLOCK(ATOMIC_RESTORESTATE){TCCR2A|=(1<<COM2B1);}}
+
+/**Each joint is driven by the same state machine, run from one table in
+ * flash.  The joint being stepped is "joint", which the guards and actions
+ * below work on.
+ */
+enum joint_ST {init_JOINT, moveUp_JOINT, moveDown_JOINT, holdStill_JOINT, detached_JOINT};
 
-enum state_RIGHT {init_RIGHT, moveUp_RIGHT, moveDown_RIGHT, holdStill_RIGHT};
-int rightTarget;
-void setRightTarget(int target){rightTarget=target;}
-int rightAtTarget(){return rightTarget==positionRightShoulder();}
-void moveRight()
+struct servoJoint
 {
-  static state_RIGHT state=init_RIGHT;
-  switch(state)
-  {
-    case init_RIGHT:
-      rightTarget=90;
-      state=holdStill_RIGHT;
-      break;
-    case moveUp_RIGHT:
-      if(rightTarget>positionRightShoulder()) state=moveUp_RIGHT;
-      else if(rightTarget<positionRightShoulder()) state=moveDown_RIGHT;
-      else state=holdStill_RIGHT;
-      break;
-    case moveDown_RIGHT:
-      if(rightTarget>positionRightShoulder()) state=moveUp_RIGHT;
-      else if(rightTarget<positionRightShoulder()) state=moveDown_RIGHT;
-      else state=holdStill_RIGHT;
-      break;
-    case holdStill_RIGHT:
-      if(rightTarget>positionRightShoulder()) state=moveUp_RIGHT;
-      else if(rightTarget<positionRightShoulder()) state=moveDown_RIGHT;
-      else state=holdStill_RIGHT;
-      break;
-    default:
-      state=init_RIGHT;
-      break;
-  }
+  int target;
+  int step;
+  unsigned char state;
+  //The frames the joint has held still
+  unsigned char held;
+  int (*position)();
+  void (*set)(int);
+  int (*detach)();
+  void (*attach)();
+};
+
+static servoJoint rightJoint={0,0,init_JOINT,0,positionRightShoulder,setRightShoulder,detachRight,attachRight};
+static servoJoint leftJoint={0,0,init_JOINT,0,positionLeftShoulder,setLeftShoulder,detachLeft,attachLeft};
+//The spine's "up" is to the left
+static servoJoint spineJoint={0,0,init_JOINT,0,positionSpine,setSpine,detachSpine,attachSpine};
+
+static servoJoint* joint;
+
+static int belowTarget(){return joint->target>joint->position();}
+static int aboveTarget(){return joint->target<joint->position();}
+static int cannotStart(){return joint->target==joint->position() || !servoStart();}
+static void centreTarget(){joint->target=90;}
+
+//A joint is detached once it has held still long enough and no pulse is
+//under way.  If one is, it is tried again next frame
+static int holdDone()
+{
+  return joint->target==joint->position() && joint->held>=SERVO_HOLD_FRAMES
+    && joint->detach();
+}
+static int stillAtTarget(){return joint->target==joint->position();}
 
-  switch(state)
-  {
-    case init_RIGHT:
-      break;
-    case moveUp_RIGHT:
-        if(rightTarget-positionRightShoulder()<4) setRightShoulder(rightTarget);
-        else setRightShoulder(positionRightShoulder()-4);
-        break;
-    case moveDown_RIGHT:
-        if(positionRightShoulder()-rightTarget<4) setRightShoulder(rightTarget);
-        else setRightShoulder(positionRightShoulder()+4);
-        break;
-    case holdStill_RIGHT:
-      break;
-    default:
-      break;
-  }
+static void stepUp()
+{
+  joint->held=0;
+  joint->step=rampStep(joint->step);
+  if(joint->target-joint->position()<=joint->step) joint->set(joint->target);
+  else joint->set(joint->position()+joint->step);
 }
 
-void servoTick()
+static void stepDown()
 {
-  moveRight();
-  moveLeft();
-  moveSpine();
+  joint->held=0;
+  joint->step=rampStep(joint->step);
+  if(joint->position()-joint->target<=joint->step) joint->set(joint->target);
+  else joint->set(joint->position()-joint->step);
 }
 
+static void stopStep()
+{
+  joint->step=0;
+  if(joint->held<SERVO_HOLD_FRAMES) joint->held++;
+}
 
+//The joint's pulse is still staged, so it resumes where it was
+static void reattach()
+{
+  joint->held=0;
+  joint->attach();
+}
 
-
+constexpr fsmTransition jointTransitions[] PROGMEM=
+{
+  FSM_ROW(init_JOINT,      0,             centreTarget, holdStill_JOINT),
+  FSM_ROW(moveUp_JOINT,    belowTarget,   0,            moveUp_JOINT),
+  FSM_ROW(moveUp_JOINT,    aboveTarget,   0,            moveDown_JOINT),
+  FSM_ROW(moveUp_JOINT,    0,             0,            holdStill_JOINT),
+  FSM_ROW(moveDown_JOINT,  belowTarget,   0,            moveUp_JOINT),
+  FSM_ROW(moveDown_JOINT,  aboveTarget,   0,            moveDown_JOINT),
+  FSM_ROW(moveDown_JOINT,  0,             0,            holdStill_JOINT),
+  FSM_ROW(holdStill_JOINT, holdDone,      0,            detached_JOINT),
+  FSM_ROW(holdStill_JOINT, cannotStart,   0,            holdStill_JOINT),
+  FSM_ROW(holdStill_JOINT, belowTarget,   0,            moveUp_JOINT),
+  FSM_ROW(holdStill_JOINT, 0,             0,            moveDown_JOINT),
+  FSM_ROW(detached_JOINT,  stillAtTarget, 0,            detached_JOINT),
+  FSM_ROW(detached_JOINT,  0,             reattach,     holdStill_JOINT),
+};
+constexpr fsmAction jointActions[] PROGMEM={0,stepUp,stepDown,stopStep,0};
+#ifdef FSM_EXPORT
+const char* const jointNames[]={"init","moveUp","moveDown","holdStill","detached"};
+#endif
+FSM_CHECK(joint);
+FSM_MACHINE(joint);
+
+static void moveJoint(servoJoint* j)
+{
+  joint=j;
+  j->state=fsmStep(&jointMachine,j->state);
+}
+
+void setSpineTarget(int target){spineJoint.target=target;}
+int spineAtTarget(){return spineJoint.target==positionSpine();}
+void moveSpine(){moveJoint(&spineJoint);}
+
+void setLeftTarget(int target){leftJoint.target=target;}
+int leftAtTarget(){return leftJoint.target==positionLeftShoulder();}
+void moveLeft(){moveJoint(&leftJoint);}
+
+void setRightTarget(int target){rightJoint.target=target;}
+int rightAtTarget(){return rightJoint.target==positionRightShoulder();}
+void moveRight(){moveJoint(&rightJoint);}
+
+unsigned char servosDetached()
+{
+  return (rightJoint.state==detached_JOINT)+(leftJoint.state==detached_JOINT)
+    +(spineJoint.state==detached_JOINT);
+}
+
+/**Updates the power budget, then advances the three joints
+ */
+void servoTick()
+{
+  //Back off the step size while the supply sags, and recover it after
+  if(supplyLow())
+  {
+    if(stepLimit>1) stepLimit--;
+  }
+  else if(stepLimit<SERVO_MAX_STEP) stepLimit++;
+
+  //Count the joints still ramping up, which is what the budget limits
+  ramping=isRamping(leftJoint.step)+isRamping(rightJoint.step)+isRamping(spineJoint.step);
+  if(staggerCount<SERVO_STAGGER_FRAMES) staggerCount++;
+
+  moveRight();
+  moveLeft();
+  moveSpine();
+}
\ No newline at end of file
@@ -1,8 +1,36 @@
 /**This library is written to interface with three servos using PWM.  Two servos
  * are controlled using Timer 1, and their PWM inputs should be connected to
  * output A and output B respectively.  The third servo should be connected to 
- * Timer 2's output A. 
+ * Timer 2's output B (pin D3), which leaves Timer 2's output A pin free to
+ * be the SPI bus's MOSI. 
  */
+//The largest step a joint takes in one 20ms frame, in degrees
+#define SERVO_MAX_STEP 4
+
+//How many joints may ramp up to full speed at the same time
+#define SERVO_MAX_ACCELERATING 2
+
+//The fewest frames between two joints starting to move
+#define SERVO_STAGGER_FRAMES 3
+
+//Below this supply voltage (in millivolts) the servos slow down
+#define SERVO_SUPPLY_LOW_MV 4300
+
+//How long a joint holds still at its target before its pulses are
+//stopped, in milliseconds.  A servo without pulses draws no holding
+//current and doesn't buzz.  It is driven again when it has a new target
+#define SERVO_HOLD_MS 1500
+
+//The timer counts kept clear of the start of the next pulse when a joint
+//is detached, so the detach can't land on the pulse's rising edge
+#define SERVO_DETACH_MARGIN_US 64
+
+//The joints, as indices into settings.trim
+#define SERVO_RIGHT 0
+#define SERVO_LEFT 1
+#define SERVO_SPINE 2
+#define SERVO_JOINTS 3
+
 //Configure the three servos
 void configurePWM1();
 void configurePWM2();
@@ -44,7 +72,21 @@ int rightAtTarget();
 void moveRight();
 
 
-//Advances state machine one tick (calling the three move__ functions above)
+//Returns 1 once per 20ms PWM frame, when the positions set during the
+//last frame have been sent to the servos, and 0 otherwise
+int servoFrame();
+
+//Returns how many frames began before the previous one was taken by
+//servoFrame(), which is how often the servos have missed an update
+unsigned char servoOverruns();
+
+//Returns the number of joints whose pulses are stopped
+unsigned char servosDetached();
+
+//Advances state machine one frame (calling the three move__ functions above).
+//Call it whenever servoFrame() returns 1.
+//A joint only starts moving toward a new target when the power budget
+//allows it, so a new target can take a few frames to be acted on
 void servoTick();
 
 
@@ -0,0 +1,103 @@
+/**This library stores each copy of the settings as a record with the
+ * layout version, a sequence number and a CRC.  A copy whose CRC is wrong,
+ * such as one cut short by a power failure, is ignored, and the newest of
+ * the rest is loaded.
+ */
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <stddef.h>
+#include <string.h>
+#include "settings.h"
+#include "accelerometer.h"
+#include "thermometer.h"
+#include "control.h"
+#include "clock.h"
+
+struct settingsRecord
+{
+  unsigned char version;
+  unsigned char sequence;
+  settingsLayout settings;
+  unsigned int crc;
+};
+
+static settingsRecord slots[SETTINGS_SLOTS] EEMEM;
+
+settingsLayout settings;
+
+//The copy being written, the slot and byte it has reached, and when
+static settingsRecord record;
+static unsigned char slot;
+static unsigned char written=sizeof(settingsRecord);
+static unsigned long lastSave;
+static unsigned char changed;
+
+static void defaults()
+{
+  memset(&settings,0,sizeof(settings));
+  settings.shakeThreshold=ACCEL_THRESHOLD;
+  settings.senseDelayMs=ACCEL_SENSE_DELAY_MS;
+  settings.warmingRate=THERM_WARMING_RATE;
+  settings.pauseMs=CONTROL_PAUSE_MS;
+}
+
+/**Returns the CRC of everything in a record before the CRC itself
+ */
+static unsigned int recordCrc(const settingsRecord* r)
+{
+  const unsigned char* bytes=(const unsigned char*)r;
+  unsigned int crc=0xFFFF;
+  for(unsigned char i=0;i<offsetof(settingsRecord,crc);i++) crc=_crc16_update(crc,bytes[i]);
+  return crc;
+}
+
+int loadSettings()
+{
+  unsigned char found=0;
+  defaults();
+  for(unsigned char i=0;i<SETTINGS_SLOTS;i++)
+  {
+    settingsRecord r;
+    eeprom_read_block(&r,&slots[i],sizeof(r));
+    if(r.version!=SETTINGS_VERSION || r.crc!=recordCrc(&r)) continue;
+    //The sequence wraps, so newer is judged by the difference
+    if(found && (signed char)(r.sequence-record.sequence)<=0) continue;
+    record=r;
+    slot=i;
+    found=1;
+  }
+  if(found) settings=record.settings;
+  return found;
+}
+
+void settingsChanged()
+  {changed=1;}
+
+/**A save starts by freezing a copy of the settings in the next slot's
+ * record.  Then each call writes one byte of it, if the EEPROM has finished
+ * the last, so the loop never waits the few milliseconds a byte takes.
+ * Bytes that already hold the right value aren't written at all
+ */
+void settingsTick()
+{
+  if(written<sizeof(settingsRecord))
+  {
+    if(!eeprom_is_ready()) return;
+    eeprom_update_byte((unsigned char*)&slots[slot]+written,((unsigned char*)&record)[written]);
+    written++;
+    return;
+  }
+  //The first change after boot is saved at once, so a new calibration
+  //isn't lost to a short run
+  if(!changed || (lastSave && clockMillis()-lastSave<SETTINGS_SAVE_MS)) return;
+  changed=0;
+  if(record.version==SETTINGS_VERSION && !memcmp(&record.settings,&settings,sizeof(settings))) return;
+
+  record.version=SETTINGS_VERSION;
+  record.sequence++;
+  record.settings=settings;
+  record.crc=recordCrc(&record);
+  if(++slot>=SETTINGS_SLOTS) slot=0;
+  written=0;
+  lastSave=clockMillis();
+}
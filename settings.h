@@ -0,0 +1,54 @@
+#ifndef settings_h
+#define settings_h
+/**This library keeps the calibration and tuning values in EEPROM, so the
+ * robot starts with what it learned last time instead of measuring again.
+ * The values live in the settings structure while the robot runs.  Anything
+ * that changes one calls settingsChanged(), and settingsTick() writes them
+ * back in the background, a byte at a time, no more often than
+ * SETTINGS_SAVE_MS and only when they differ from what was last saved.
+ */
+#include "servo.h"
+
+//Bump this whenever settingsLayout changes, so old copies are ignored
+#define SETTINGS_VERSION 3
+
+//The copies kept in EEPROM.  Each save goes to the next one, which spreads
+//the wear, and leaves the last good copy alone in case power fails
+#define SETTINGS_SLOTS 8
+
+//The fewest milliseconds between two saves
+#define SETTINGS_SAVE_MS 600000UL
+
+struct settingsLayout
+{
+  //The gravitational offsets found by calibrate(), in the sensor's units,
+  //and whether they have been measured at all
+  int xBase;
+  int yBase;
+  int zBase;
+  unsigned char calibrated;
+  //The acceleration that counts as a shake, in the sensor's units, and
+  //how long to wait after one before measuring again (see accelerometer.h)
+  unsigned int shakeThreshold;
+  unsigned int senseDelayMs;
+  //The rise in temperature that counts as a hand (see thermometer.h)
+  int warmingRate;
+  //How long control waits after a reaction (see control.h)
+  unsigned int pauseMs;
+  //Degrees added to each joint's position, to line the horns up
+  signed char trim[SERVO_JOINTS];
+};
+
+extern settingsLayout settings;
+
+//Loads the newest good copy from EEPROM, or the defaults if there isn't
+//one.  Returns 1 if a copy was loaded.  Call first in setup
+int loadSettings();
+
+//Marks the settings as changed, to be saved by settingsTick()
+void settingsChanged();
+
+//Writes a changed copy back to EEPROM, one byte per call.  Call every tick
+void settingsTick();
+
+#endif
@@ -0,0 +1,614 @@
+/*
+ * A full system simulation of the animatronic for simavr.
+ *
+ * The firmware image runs on a simulated ATmega328P with a virtual GY-521
+ * on the I2C bus.  A script moves the sensor, presses the button and sets
+ * the analog inputs over time.  Probes on the pins capture every servo
+ * pulse, the sound board's UART commands (or the PCM audio output), and
+ * how much of the time awake the CPU spends outside the main loop's idle
+ * spin.  The time spent asleep in standby is measured, and how long each
+ * wake up takes.  While a track plays, the virtual sound board holds its
+ * envelope output on ADC6 up, and the time from each sound to the lip sync
+ * moving the spine is measured.  At the end a JSON report is written to
+ * stdout.  tools/sim.py builds and runs this.
+ *
+ *   mmsim [options] firmware.elf
+ *     -s script    the script of inputs (see sim/shake.script)
+ *     -t ms        how long to run, in simulated milliseconds
+ *     -b address   the data address of ticksDue, to measure the time from
+ *                  a wake to the next tick
+ *     -l start:end the flash addresses of a function the idle spin runs
+ *                  (main, myLoop, servoFrame), to measure the CPU load.
+ *                  Given once for each
+ *     -B address   the data address of bootTimes, to report the boot phases
+ *     -p ms        how long the virtual sound board plays each track
+ *     -i mA        the holding current of one servo, to estimate what
+ *                  detaching idle servos saves (100 by default)
+ *
+ * Script lines are "<ms> <command> [arguments]", in order of time:
+ *     accel x y z   set the raw accelerometer readings
+ *     temp c        set the sensor's temperature, in hundredths of a degree
+ *     button 0|1    release or press the button (which wakes the
+ *                   firmware from standby)
+ *     adc n mv      set analog input n to mv millivolts
+ *     shake         mark the start of a shake; the latency from here to
+ *                   the next sound and the next servo motion is measured
+ *
+ * The sensor's INT pin is wired to D2, and idles high, as it does once the
+ * firmware has made it active low.  A change of acceleration big enough
+ * for its motion interrupt wakes the firmware from standby.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "avr_ioport.h"
+#include "avr_uart.h"
+#include "avr_adc.h"
+#include "mpu6050.h"
+
+#define MAX_EVENTS 1024
+#define MAX_MARKS 64
+#define MAX_WAKES 64
+#define MAX_SOUNDS 64
+#define MAX_IDLE 4
+
+/* Servo pulses outside this range (in microseconds) are glitches */
+#define PULSE_MIN_US 400
+#define PULSE_MAX_US 2600
+
+/* A servo without a pulse for this long (in milliseconds) is detached */
+#define DETACHED_MS 50
+
+/* Typical currents from the datasheets, in microamps, for the estimate of
+ * the average current.  Awake: the ATmega328P running at 1MHz and 5V, and
+ * the MPU-6050 with every sensor on.  Asleep: the ATmega in power down with
+ * the brown out detector off, and the MPU-6050 with only its accelerometer,
+ * woken 1.25 times a second.  The sound board and the servos are left out,
+ * as standby turns both off */
+#define AWAKE_UA (550 + 3900)
+#define ASLEEP_UA (1 + 10)
+
+/* The sound board's envelope on ADC6 while it plays, in millivolts */
+#define ENVELOPE_MV 2500
+/* The PCM output is quiet between sounds for at least this long, in
+ * milliseconds */
+#define QUIET_MS 50
+
+typedef struct event_t {
+	unsigned long ms;
+	char command[16];
+	long arg[3];
+} event_t;
+
+typedef struct probe_t {
+	const char * name;
+	int servo;
+	uint64_t rise;		/* cycle of the last rising edge, 0 before one */
+	unsigned long pulses;
+	uint32_t width;
+	uint32_t width_min, width_max;
+	uint32_t period_min, period_max;
+	unsigned long changes;	/* pulses wider or narrower than the last */
+	unsigned long glitches;
+	uint64_t last_change;	/* cycle of the last change of width */
+	unsigned long detaches;
+	uint64_t detached;	/* cycles spent without pulses */
+} probe_t;
+
+enum { PROBE_RIGHT, PROBE_LEFT, PROBE_SPINE, PROBE_AUDIO, PROBES };
+
+static probe_t probes[PROBES] = {
+	[PROBE_RIGHT] = { .name = "OC1A", .servo = 1 },
+	[PROBE_LEFT] = { .name = "OC1B", .servo = 1 },
+	[PROBE_SPINE] = { .name = "OC2B", .servo = 1 },
+	[PROBE_AUDIO] = { .name = "OC0B" },
+};
+
+static avr_t * avr;
+static mpu6050_t mpu;
+
+static event_t events[MAX_EVENTS];
+static int event_count;
+
+/* The latency measurement of each shake */
+typedef struct mark_t {
+	uint64_t cycle;
+	uint64_t sound;
+	uint64_t motion;
+	uint64_t reattach;	/* the first pulse of a detached servo */
+} mark_t;
+static mark_t marks[MAX_MARKS];
+static int mark_count;
+
+/* Each wake from standby, from the button press or motion that woke it */
+typedef struct wake_t {
+	uint64_t cycle;
+	uint64_t running;	/* the CPU left the sleep */
+	uint64_t tick;		/* the next tick fell due */
+	uint64_t sample;	/* the axes were read again */
+	unsigned long samples;	/* the reads of the axes before the wake */
+	int between;		/* the tick that slept has finished */
+} wake_t;
+static wake_t wakes[MAX_WAKES];
+static int wake_count;
+static int woken;		/* this sleep's wake has been recorded */
+static unsigned long sleeps;
+static uint64_t slept;		/* the cycle the last sleep began */
+static uint64_t asleep;		/* cycles spent asleep */
+
+/* Each sound, and the first motion of the spine after it */
+typedef struct sound_t {
+	uint64_t cycle;
+	uint64_t spine;
+} sound_t;
+static sound_t sounds[MAX_SOUNDS];
+static int sound_count;
+
+/* The code of the idle spin.  The CPU is idle while it runs this code
+ * from one instruction to the next, so an interrupt taken from the spin,
+ * and everything a tick calls, count as busy */
+typedef struct range_t {
+	uint32_t start, end;
+} range_t;
+static range_t idle_code[MAX_IDLE];
+static int idle_count;
+
+/* The virtual sound board */
+static unsigned long hold_ma = 100;
+static unsigned long play_ms = 1000;
+static uint64_t playing_until;
+static unsigned long tracks_played;
+static unsigned long uart_bytes;
+static int line_start = 1;
+
+static double cycles_to_ms(uint64_t cycles)
+{
+	return cycles * 1000.0 / avr->frequency;
+}
+
+static uint64_t ms_to_cycles(unsigned long ms)
+{
+	return (uint64_t)ms * avr->frequency / 1000;
+}
+
+static mark_t * last_mark(void)
+{
+	return mark_count ? &marks[mark_count - 1] : NULL;
+}
+
+static mark_t * open_mark(int sound)
+{
+	mark_t * m = last_mark();
+	if (!m || (sound ? m->sound : m->motion))
+		return NULL;
+	return m;
+}
+
+static void heard_sound(void)
+{
+	mark_t * m = open_mark(1);
+	if (m)
+		m->sound = avr->cycle;
+}
+
+static void sound_started(void)
+{
+	if (sound_count < MAX_SOUNDS)
+		sounds[sound_count++] = (sound_t){ .cycle = avr->cycle };
+}
+
+static void set_act(int playing)
+{
+	/* ACT is low while the board plays, and the envelope is up */
+	avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 6), !playing);
+	avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + 6),
+			playing ? ENVELOPE_MV : 0);
+}
+
+/* A byte sent to the sound board.  "#n" starts a track, "q" stops it */
+static void uart_hook(struct avr_irq_t * irq, uint32_t value, void * param)
+{
+	uart_bytes++;
+	if (line_start && value == '#') {
+		tracks_played++;
+		playing_until = avr->cycle + ms_to_cycles(play_ms);
+		set_act(1);
+		heard_sound();
+		sound_started();
+	} else if (line_start && value == 'q') {
+		playing_until = 0;
+		set_act(0);
+	}
+	line_start = value == '\n';
+}
+
+static void pin_hook(struct avr_irq_t * irq, uint32_t value, void * param)
+{
+	probe_t * p = (probe_t *)param;
+	if (value) {
+		if (p->rise) {
+			uint64_t period = avr->cycle - p->rise;
+			if (p->servo && period >= ms_to_cycles(DETACHED_MS)) {
+				/* The servo was detached, and this pulse reattaches it */
+				p->detaches++;
+				p->detached += period;
+				mark_t * m = last_mark();
+				if (m && !m->reattach && p->rise < m->cycle)
+					m->reattach = avr->cycle;
+			} else {
+				if (!p->period_min || period < p->period_min)
+					p->period_min = period;
+				if (period > p->period_max)
+					p->period_max = period;
+			}
+		}
+		p->rise = avr->cycle;
+		return;
+	}
+	if (!p->rise)
+		return;
+
+	uint32_t width = avr->cycle - p->rise;
+	if (p->pulses && width != p->width) {
+		p->changes++;
+		if (p->servo) {
+			mark_t * m = open_mark(0);
+			if (m)
+				m->motion = avr->cycle;
+			sound_t * s = sound_count ? &sounds[sound_count - 1] : NULL;
+			if (p == &probes[PROBE_SPINE] && s && !s->spine)
+				s->spine = avr->cycle;
+		} else {
+			/* The audio output sits at a fixed width until a sound plays */
+			heard_sound();
+			if (avr->cycle - p->last_change >= ms_to_cycles(QUIET_MS))
+				sound_started();
+		}
+		p->last_change = avr->cycle;
+	}
+	if (!p->pulses || width < p->width_min)
+		p->width_min = width;
+	if (width > p->width_max)
+		p->width_max = width;
+	if (p->servo) {
+		double us = width * 1e6 / avr->frequency;
+		if (us < PULSE_MIN_US || us > PULSE_MAX_US)
+			p->glitches++;
+	}
+	p->width = width;
+	p->pulses++;
+}
+
+static int in_idle_code(uint32_t pc)
+{
+	for (int i = 0; i < idle_count; i++)
+		if (pc >= idle_code[i].start && pc < idle_code[i].end)
+			return 1;
+	return 0;
+}
+
+static void read_script(const char * path)
+{
+	FILE * f = fopen(path, "r");
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+	char line[128];
+	while (fgets(line, sizeof(line), f)) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+		if (event_count >= MAX_EVENTS) {
+			fprintf(stderr, "%s: more than %d events\n", path, MAX_EVENTS);
+			exit(1);
+		}
+		event_t * e = &events[event_count];
+		if (sscanf(line, "%lu %15s %ld %ld %ld", &e->ms, e->command,
+				&e->arg[0], &e->arg[1], &e->arg[2]) < 2) {
+			fprintf(stderr, "%s: can't read \"%s\"\n", path, line);
+			exit(1);
+		}
+		event_count++;
+	}
+	fclose(f);
+}
+
+static void woke(void)
+{
+	if (woken || avr->state != cpu_Sleeping || wake_count >= MAX_WAKES)
+		return;
+	woken = 1;
+	wakes[wake_count++] = (wake_t){ .cycle = avr->cycle, .samples = mpu.samples };
+}
+
+static void run_event(event_t * e)
+{
+	unsigned long motions = mpu.motions;
+	if (!strcmp(e->command, "accel"))
+		mpu6050_set_accel(&mpu, e->arg[0], e->arg[1], e->arg[2]);
+	else if (!strcmp(e->command, "temp"))
+		mpu6050_set_temp(&mpu, e->arg[0]);
+	else if (!strcmp(e->command, "button"))
+		avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 4), !e->arg[0]);
+	else if (!strcmp(e->command, "adc"))
+		avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + e->arg[0]), e->arg[1]);
+	else if (!strcmp(e->command, "shake")) {
+		if (mark_count < MAX_MARKS)
+			marks[mark_count++] = (mark_t){ .cycle = avr->cycle };
+	} else {
+		fprintf(stderr, "unknown script command \"%s\"\n", e->command);
+		exit(1);
+	}
+	if (!strcmp(e->command, "button") || mpu.motions != motions)
+		woke();
+}
+
+/* Follows the sleeps, and each wake up until the axes are read again.
+ * The firmware sleeps in the middle of a tick, so the tick that is
+ * measured is the next one to fall due */
+static void watch_sleep(int was_sleeping, long ticks_due)
+{
+	int sleeping = avr->state == cpu_Sleeping;
+	if (sleeping && !was_sleeping) {
+		sleeps++;
+		slept = avr->cycle;
+		woken = 0;
+	} else if (!sleeping && was_sleeping) {
+		asleep += avr->cycle - slept;
+		woken = 1;
+		if (wake_count && !wakes[wake_count - 1].running)
+			wakes[wake_count - 1].running = avr->cycle;
+	}
+	wake_t * w = wake_count ? &wakes[wake_count - 1] : NULL;
+	if (!w || sleeping)
+		return;
+	if (!w->tick && ticks_due >= 0) {
+		if (!avr->data[ticks_due])
+			w->between = 1;
+		else if (w->between)
+			w->tick = avr->cycle;
+	}
+	if (!w->sample && mpu.samples != w->samples)
+		w->sample = avr->cycle;
+}
+
+enum { LATENCY_MOTION, LATENCY_SOUND, LATENCY_REATTACH };
+enum { WAKE_RUNNING, WAKE_TICK, WAKE_SAMPLE };
+
+static void print_latencies(const char * name, int which)
+{
+	printf("  \"%s\": [", name);
+	for (int i = 0; i < mark_count; i++) {
+		uint64_t at = which == LATENCY_SOUND ? marks[i].sound :
+			which == LATENCY_MOTION ? marks[i].motion : marks[i].reattach;
+		if (at)
+			printf("%s%.2f", i ? ", " : "", cycles_to_ms(at - marks[i].cycle));
+		else
+			printf("%snull", i ? ", " : "");
+	}
+	printf("],\n");
+}
+
+static void print_wakes(const char * name, int which)
+{
+	printf("\"%s\": [", name);
+	for (int i = 0; i < wake_count; i++) {
+		uint64_t at = which == WAKE_RUNNING ? wakes[i].running :
+			which == WAKE_TICK ? wakes[i].tick : wakes[i].sample;
+		if (at)
+			printf("%s%.2f", i ? ", " : "", cycles_to_ms(at - wakes[i].cycle));
+		else
+			printf("%snull", i ? ", " : "");
+	}
+	printf("]");
+}
+
+static void print_lip_sync(void)
+{
+	printf("  \"sound_to_spine_ms\": [");
+	for (int i = 0; i < sound_count; i++) {
+		if (sounds[i].spine)
+			printf("%s%.2f", i ? ", " : "", cycles_to_ms(sounds[i].spine - sounds[i].cycle));
+		else
+			printf("%snull", i ? ", " : "");
+	}
+	printf("],\n");
+}
+
+/* The average current is only of the parts that standby turns off or
+ * puts to sleep, and assumes a supply of 5V */
+static void print_standby(void)
+{
+	uint64_t awake = avr->cycle - asleep;
+	double average = ((double)awake * AWAKE_UA + (double)asleep * ASLEEP_UA) / avr->cycle;
+	printf("  \"standby\": {\"sleeps\": %lu, \"asleep_ms\": %.1f, \"motion_interrupts\": %lu, ",
+			sleeps, cycles_to_ms(asleep), mpu.motions);
+	print_wakes("wake_to_running_ms", WAKE_RUNNING);
+	printf(", ");
+	print_wakes("wake_to_tick_ms", WAKE_TICK);
+	printf(", ");
+	print_wakes("wake_to_sample_ms", WAKE_SAMPLE);
+	printf(", \"average_uA\": %.1f},\n", average);
+}
+
+/* The phases in boot.h, and the microseconds at which each was reached */
+static const char * boot_phases[] = {
+	"clock", "servos", "imu", "peripherals", "ready", "first_sample", "calibrated"
+};
+#define BOOT_PHASES (sizeof(boot_phases) / sizeof(boot_phases[0]))
+
+static void print_boot(long boot_times)
+{
+	if (boot_times < 0) {
+		printf("  \"boot_us\": null,\n");
+		return;
+	}
+	printf("  \"boot_us\": {");
+	for (unsigned i = 0; i < BOOT_PHASES; i++) {
+		const uint8_t * t = avr->data + boot_times + 4 * i;
+		uint32_t us = t[0] | t[1] << 8 | t[2] << 16 | (uint32_t)t[3] << 24;
+		printf("\"%s\": %u%s", boot_phases[i], us, i < BOOT_PHASES - 1 ? ", " : "");
+	}
+	printf("},\n");
+}
+
+static void print_report(uint64_t busy, long boot_times, int state)
+{
+	printf("{\n");
+	printf("  \"simulated_ms\": %.1f,\n", cycles_to_ms(avr->cycle));
+	printf("  \"crashed\": %s,\n", state == cpu_Crashed ? "true" : "false");
+	print_latencies("shake_to_sound_ms", LATENCY_SOUND);
+	print_latencies("shake_to_motion_ms", LATENCY_MOTION);
+	print_latencies("shake_to_reattach_ms", LATENCY_REATTACH);
+	print_lip_sync();
+	print_boot(boot_times);
+	print_standby();
+	printf("  \"pulses\": {\n");
+	for (int i = 0; i < PROBES; i++) {
+		probe_t * p = &probes[i];
+		printf("    \"%s\": {\"count\": %lu, \"width_min\": %u, \"width_max\": %u, "
+				"\"period_min\": %u, \"period_max\": %u, \"period_jitter\": %u, "
+				"\"changes\": %lu, \"glitches\": %lu, "
+				"\"detaches\": %lu, \"detached_ms\": %.1f}%s\n",
+				p->name, p->pulses, p->width_min, p->width_max,
+				p->period_min, p->period_max, p->period_max - p->period_min,
+				p->changes, p->glitches, p->detaches, cycles_to_ms(p->detached),
+				i < PROBES - 1 ? "," : "");
+	}
+	printf("  },\n");
+	/* The holding current each servo didn't draw while detached */
+	double detached_ms = 0;
+	for (int i = 0; i < PROBES; i++)
+		detached_ms += cycles_to_ms(probes[i].detached);
+	printf("  \"holding_saved_mAh\": %.3f,\n", detached_ms * hold_ma / 3600000.0);
+	printf("  \"voice\": {\"tracks\": %lu, \"uart_bytes\": %lu},\n", tracks_played, uart_bytes);
+	printf("  \"i2c\": {\"transfers\": %lu, \"bytes_read\": %lu, \"bytes_written\": %lu},\n",
+			mpu.transfers, mpu.reads, mpu.writes);
+	if (busy == (uint64_t)-1)
+		printf("  \"cpu_load\": null\n");
+	else
+		printf("  \"cpu_load\": %.4f\n", (double)busy / (avr->cycle - asleep));
+	printf("}\n");
+}
+
+int main(int argc, char * argv[])
+{
+	const char * script = NULL;
+	unsigned long duration = 10000;
+	long ticks_due = -1;
+	long boot_times = -1;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:t:b:B:p:i:l:")) != -1) {
+		switch (opt) {
+		case 's': script = optarg; break;
+		case 't': duration = strtoul(optarg, NULL, 0); break;
+		case 'b': ticks_due = strtol(optarg, NULL, 0) & 0xffff; break;
+		case 'B': boot_times = strtol(optarg, NULL, 0) & 0xffff; break;
+		case 'p': play_ms = strtoul(optarg, NULL, 0); break;
+		case 'i': hold_ma = strtoul(optarg, NULL, 0); break;
+		case 'l':
+			if (idle_count >= MAX_IDLE || sscanf(optarg, "%i:%i",
+					&idle_code[idle_count].start, &idle_code[idle_count].end) != 2) {
+				fprintf(stderr, "%s: bad -l %s\n", argv[0], optarg);
+				return 1;
+			}
+			idle_count++;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-s script] [-t ms] [-b address] [-B address] [-p ms] [-i mA] [-l start:end] firmware.elf\n", argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "%s: no firmware given\n", argv[0]);
+		return 1;
+	}
+	if (script)
+		read_script(script);
+
+	elf_firmware_t firmware = {{0}};
+	if (elf_read_firmware(argv[optind], &firmware)) {
+		fprintf(stderr, "%s: can't read %s\n", argv[0], argv[optind]);
+		return 1;
+	}
+	avr = avr_make_mcu_by_name("atmega328p");
+	if (!avr) {
+		fprintf(stderr, "%s: simavr has no atmega328p\n", argv[0]);
+		return 1;
+	}
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+	avr->frequency = 1000000;
+	avr->vcc = avr->avcc = avr->aref = 5000;
+
+	mpu6050_init(avr, &mpu);
+	mpu6050_attach(avr, &mpu);
+	avr_connect_irq(mpu.irq + MPU6050_IRQ_INT,
+			avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2));
+
+	/* Keep the firmware's UART traffic off stdout, and listen to it */
+	uint32_t flags = 0;
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+			uart_hook, NULL);
+
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 1),
+			pin_hook, &probes[PROBE_RIGHT]);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 2),
+			pin_hook, &probes[PROBE_LEFT]);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 3),
+			pin_hook, &probes[PROBE_SPINE]);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 5),
+			pin_hook, &probes[PROBE_AUDIO]);
+
+	/* The button is released, the sensor's INT idle and the sound board
+	 * idle */
+	avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 4), 1);
+	avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2), 1);
+	set_act(0);
+
+	uint64_t end = ms_to_cycles(duration);
+	uint64_t busy = idle_count ? 0 : (uint64_t)-1;
+	int next = 0;
+	int state = cpu_Running;
+	while (avr->cycle < end) {
+		while (next < event_count && ms_to_cycles(events[next].ms) <= avr->cycle)
+			run_event(&events[next++]);
+		if (playing_until && avr->cycle >= playing_until) {
+			playing_until = 0;
+			set_act(0);
+		}
+
+		/* Every cycle awake is busy, but those of an instruction of the
+		 * idle spin that led to another */
+		int sleeping = avr->state == cpu_Sleeping;
+		int idle = in_idle_code(avr->pc);
+		uint64_t before = avr->cycle;
+		state = avr_run(avr);
+		if (!sleeping && avr->state != cpu_Sleeping && !(idle && in_idle_code(avr->pc)))
+			busy += avr->cycle - before;
+		watch_sleep(sleeping, ticks_due);
+		if (state == cpu_Done || state == cpu_Crashed)
+			break;
+	}
+
+	/* A sleep that lasts to the end is counted up to the end */
+	if (avr->state == cpu_Sleeping)
+		asleep += avr->cycle - slept;
+
+	/* A servo still detached at the end has been since its last pulse */
+	for (int i = 0; i < PROBES; i++) {
+		probe_t * p = &probes[i];
+		if (p->servo && p->rise && avr->cycle - p->rise >= ms_to_cycles(DETACHED_MS))
+			p->detached += avr->cycle - p->rise;
+	}
+	print_report(busy, boot_times, state);
+	return state == cpu_Crashed;
+}
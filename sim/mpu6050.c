@@ -0,0 +1,133 @@
+/*
+ * A virtual MPU-6050 for simavr, written after simavr's i2c_eeprom part.
+ */
+#include <string.h>
+#include "avr_twi.h"
+#include "mpu6050.h"
+
+static const char * irq_names[3] = {
+	[TWI_IRQ_INPUT] = "8>mpu6050.out",
+	[TWI_IRQ_OUTPUT] = "32<mpu6050.in",
+	[MPU6050_IRQ_INT] = "1>mpu6050.int",
+};
+
+static void set_word(mpu6050_t * p, uint8_t reg, int16_t value)
+{
+	p->regs[reg] = (uint16_t)value >> 8;
+	p->regs[reg + 1] = value & 0xff;
+}
+
+/* Drives INT to its active level (low with INT_LEVEL set) or releases it */
+static void set_int(mpu6050_t * p, int active)
+{
+	int low = p->regs[MPU6050_INT_PIN_CFG] & 0x80;
+	avr_raise_irq(p->irq + MPU6050_IRQ_INT, active ? !low : !!low);
+}
+
+/* Called for every message the AVR's TWI module puts on the bus */
+static void mpu6050_in_hook(struct avr_irq_t * irq, uint32_t value, void * param)
+{
+	mpu6050_t * p = (mpu6050_t *)param;
+	avr_twi_msg_irq_t v;
+	v.u.v = value;
+
+	if (v.u.twi.msg & TWI_COND_STOP)
+		p->selected = 0;
+
+	if (v.u.twi.msg & TWI_COND_START) {
+		p->selected = 0;
+		p->pointer_set = 0;
+		if ((v.u.twi.addr >> 1) == MPU6050_ADDR) {
+			p->selected = v.u.twi.addr;
+			p->transfers++;
+			avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+					avr_twi_irq_msg(TWI_COND_ACK, p->selected, 1));
+		}
+	}
+
+	if (!p->selected)
+		return;
+
+	if (v.u.twi.msg & TWI_COND_WRITE) {
+		avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+				avr_twi_irq_msg(TWI_COND_ACK, p->selected, 1));
+		if (!p->pointer_set) {
+			p->reg = v.u.twi.data & 0x7f;
+			p->pointer_set = 1;
+		} else {
+			p->regs[p->reg] = v.u.twi.data;
+			p->reg = (p->reg + 1) & 0x7f;
+			p->writes++;
+		}
+	}
+
+	if (v.u.twi.msg & TWI_COND_READ) {
+		if (p->reg == MPU6050_ACCEL_XOUT_H)
+			p->samples++;
+		avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+				avr_twi_irq_msg(TWI_COND_READ, p->selected, p->regs[p->reg]));
+		if (p->reg == MPU6050_INT_STATUS && p->regs[MPU6050_INT_STATUS]) {
+			p->regs[MPU6050_INT_STATUS] = 0;
+			set_int(p, 0);
+		}
+		p->reg = (p->reg + 1) & 0x7f;
+		p->reads++;
+	}
+}
+
+void mpu6050_init(avr_t * avr, mpu6050_t * p)
+{
+	memset(p, 0, sizeof(*p));
+	p->irq = avr_alloc_irq(&avr->irq_pool, 0, 3, irq_names);
+	avr_irq_register_notify(p->irq + TWI_IRQ_OUTPUT, mpu6050_in_hook, p);
+
+	/* The power on state: asleep, and lying flat */
+	p->regs[MPU6050_PWR_MGMT_1] = 0x40;
+	p->regs[MPU6050_WHO_AM_I] = MPU6050_ADDR;
+	mpu6050_set_accel(p, 0, 0, 16384);
+	mpu6050_set_temp(p, 2500);
+}
+
+void mpu6050_attach(avr_t * avr, mpu6050_t * p)
+{
+	avr_connect_irq(p->irq + TWI_IRQ_INPUT,
+			avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+	avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+			p->irq + TWI_IRQ_OUTPUT);
+}
+
+static int16_t get_word(mpu6050_t * p, uint8_t reg)
+{
+	return (int16_t)(p->regs[reg] << 8 | p->regs[reg + 1]);
+}
+
+/* One unit of MOT_THR is 2mg, which is 32.768 at the 2g range */
+static int moved(mpu6050_t * p, int16_t x, int16_t y, int16_t z)
+{
+	long threshold = p->regs[MPU6050_MOT_THR] * 32768L / 1000;
+	int16_t now[3] = { x, y, z };
+	for (int i = 0; i < 3; i++) {
+		long change = (long)now[i] - get_word(p, MPU6050_ACCEL_XOUT_H + 2 * i);
+		if (change > threshold || -change > threshold)
+			return 1;
+	}
+	return 0;
+}
+
+void mpu6050_set_accel(mpu6050_t * p, int16_t x, int16_t y, int16_t z)
+{
+	if ((p->regs[MPU6050_INT_ENABLE] & 0x40) && moved(p, x, y, z)) {
+		p->regs[MPU6050_INT_STATUS] |= 0x40;
+		p->motions++;
+		set_int(p, 1);
+	}
+	set_word(p, MPU6050_ACCEL_XOUT_H, x);
+	set_word(p, MPU6050_ACCEL_XOUT_H + 2, y);
+	set_word(p, MPU6050_ACCEL_XOUT_H + 4, z);
+}
+
+/* The datasheet gives degrees = TEMP_OUT/340 + 36.53 */
+void mpu6050_set_temp(mpu6050_t * p, int centidegrees)
+{
+	set_word(p, MPU6050_TEMP_OUT_H, (int16_t)((centidegrees - 3653) * 340L / 100));
+}
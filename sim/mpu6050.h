@@ -0,0 +1,62 @@
+/*
+ * A virtual MPU-6050 (the sensor on the GY-521 board) for simavr.
+ *
+ * It answers on the I2C bus at MPU6050_ADDR like the real part: the first
+ * byte written after the address selects a register, further bytes written
+ * are stored from there on, and reads return bytes from there on, the
+ * register pointer moving on after each byte.  The simulation sets the
+ * sensor readings with mpu6050_set_accel() and mpu6050_set_temp().
+ *
+ * The motion interrupt is modelled too: with MOT_EN set in INT_ENABLE, a
+ * change of any axis by more than MOT_THR (in units of 2mg) drives the
+ * MPU6050_IRQ_INT output to its active level until INT_STATUS is read.
+ */
+#ifndef MPU6050_H
+#define MPU6050_H
+
+#include <stdint.h>
+#include "sim_avr.h"
+#include "sim_irq.h"
+
+#define MPU6050_ADDR 0x68
+
+#define MPU6050_SMPLRT_DIV 0x19
+#define MPU6050_CONFIG 0x1A
+#define MPU6050_ACCEL_CONFIG 0x1C
+#define MPU6050_MOT_THR 0x1F
+#define MPU6050_INT_PIN_CFG 0x37
+#define MPU6050_INT_ENABLE 0x38
+#define MPU6050_INT_STATUS 0x3A
+#define MPU6050_ACCEL_XOUT_H 0x3B
+#define MPU6050_TEMP_OUT_H 0x41
+#define MPU6050_PWR_MGMT_1 0x6B
+#define MPU6050_WHO_AM_I 0x75
+
+/* The INT pin, after the two TWI irqs */
+#define MPU6050_IRQ_INT 2
+
+typedef struct mpu6050_t {
+	avr_irq_t * irq;	/* TWI_IRQ_INPUT, TWI_IRQ_OUTPUT and MPU6050_IRQ_INT */
+	uint8_t selected;	/* the address byte while addressed, else 0 */
+	uint8_t pointer_set;	/* the register has been written this transfer */
+	uint8_t reg;
+	uint8_t regs[128];
+	unsigned long reads;	/* bytes read and written by the firmware */
+	unsigned long writes;
+	unsigned long transfers;
+	unsigned long samples;	/* reads of the axes */
+	unsigned long motions;	/* motion interrupts raised */
+} mpu6050_t;
+
+void mpu6050_init(avr_t * avr, mpu6050_t * p);
+
+/* Connects the sensor to TWI module 0 */
+void mpu6050_attach(avr_t * avr, mpu6050_t * p);
+
+/* Sets the raw accelerometer readings (16384 is 1g at the 2g range) */
+void mpu6050_set_accel(mpu6050_t * p, int16_t x, int16_t y, int16_t z);
+
+/* Sets the die temperature, in hundredths of a degree Celsius */
+void mpu6050_set_temp(mpu6050_t * p, int centidegrees);
+
+#endif
@@ -0,0 +1,144 @@
+/**This library reads a SPI NOR flash chip with the standard READ DATA
+ * command (0x03), which works at any SPI clock the ATmega can make.  The
+ * four command and address bytes of a read are always sent by waiting on
+ * the bus, since they take only a few microseconds; the data bytes of an
+ * asynchronous read are then clocked in one per SPI interrupt.
+ */
+#include "spiflash.h"
+
+#ifdef __AVR__
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#define FLASH_CS 0x01
+#define READ_DATA 0x03
+#define RELEASE_POWER_DOWN 0xAB
+
+static volatile unsigned char busy;
+static unsigned char* asyncBuffer;
+static unsigned char asyncLeft;
+
+static void select()
+  {PORTB&=~FLASH_CS;}
+
+static void deselect()
+  {PORTB|=FLASH_CS;}
+
+/**Sends a byte and returns the byte received at the same time
+ */
+static unsigned char transfer(unsigned char out)
+{
+  SPDR=out;
+  while(!(SPSR&(1<<SPIF)));
+  return SPDR;
+}
+
+/**Claims the bus.  Returns 0 if it is in use
+ */
+static int claim()
+{
+  int claimed=0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if(!busy)
+    {
+      busy=1;
+      claimed=1;
+    }
+  }
+  return claimed;
+}
+
+static void sendRead(unsigned long address)
+{
+  select();
+  transfer(READ_DATA);
+  transfer(address>>16);
+  transfer(address>>8);
+  transfer(address);
+}
+
+/**Configure the SPI bus as master in mode 0, at half the CPU clock
+ */
+void setUpSpiFlash()
+{
+  //Chip select idles high.  SS (B2) must be an output for master mode,
+  //which it already is as Timer 1's output B
+  PORTB|=FLASH_CS;
+  DDRB|=FLASH_CS|(1<<PB2)|(1<<PB3)|(1<<PB5);
+  DDRB&=~(1<<PB4);
+  SPCR=(1<<SPE)|(1<<MSTR);
+  SPSR=(1<<SPI2X);
+
+  //Wake the chip in case it was left powered down
+  select();
+  transfer(RELEASE_POWER_DOWN);
+  deselect();
+}
+
+void spiFlashRead(unsigned long address, unsigned char* buffer, unsigned int length)
+{
+  while(!claim());
+  sendRead(address);
+  while(length--) *buffer++=transfer(0);
+  deselect();
+  busy=0;
+}
+
+int spiFlashReadAsync(unsigned long address, unsigned char* buffer, unsigned char length)
+{
+  if(!length || !claim()) return 0;
+  sendRead(address);
+  asyncBuffer=buffer;
+  asyncLeft=length;
+  //The interrupt takes over from the first data byte
+  SPCR|=(1<<SPIE);
+  SPDR=0;
+  return 1;
+}
+
+int spiFlashBusy()
+  {return busy;}
+
+ISR(SPI_STC_vect)
+{
+  *asyncBuffer++=SPDR;
+  if(--asyncLeft) SPDR=0;
+  else
+  {
+    SPCR&=~(1<<SPIE);
+    deselect();
+    busy=0;
+  }
+}
+
+#else
+
+#include <stdio.h>
+#include <string.h>
+
+static FILE* image;
+
+void setUpSpiFlash()
+  {image=fopen(SPIFLASH_IMAGE,"rb");}
+
+/**Bytes past the end of the image read as 0xFF, like erased flash
+ */
+void spiFlashRead(unsigned long address, unsigned char* buffer, unsigned int length)
+{
+  memset(buffer,0xFF,length);
+  if(image && !fseek(image,address,SEEK_SET)) fread(buffer,1,length,image);
+}
+
+//The stand-in finishes every read before returning
+int spiFlashReadAsync(unsigned long address, unsigned char* buffer, unsigned char length)
+{
+  spiFlashRead(address,buffer,length);
+  return 1;
+}
+
+int spiFlashBusy()
+  {return 0;}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef spiflash_h
+#define spiflash_h
+/**This library reads a SPI NOR flash chip (a W25Q32 or similar) on the
+ * ATmega's hardware SPI bus: MOSI on B3, MISO on B4, SCK on B5, and the
+ * chip select on B0.  Reads can either wait for their data, or run from
+ * the SPI interrupt while the caller gets on with other work.  The chip
+ * is only ever read; it is programmed with an image from tools/mkassets.py.
+ *
+ * On a host build (without __AVR__) the chip is stood in for by the image
+ * file SPIFLASH_IMAGE, so the code above it can be run and tested on a PC.
+ */
+
+#ifndef SPIFLASH_IMAGE
+#define SPIFLASH_IMAGE "assets.bin"
+#endif
+
+//Configure the SPI bus and wake the chip
+void setUpSpiFlash();
+
+//Reads length bytes starting at address, and waits for them.  Must not
+//be called from an interrupt
+void spiFlashRead(unsigned long address, unsigned char* buffer, unsigned int length);
+
+//Starts reading length bytes starting at address into buffer, and returns
+//at once.  Returns 0 without starting if the bus is already in use
+int spiFlashReadAsync(unsigned long address, unsigned char* buffer, unsigned char length);
+
+//Returns 1 while a read is in progress, 0 otherwise
+int spiFlashBusy();
+
+#endif
@@ -0,0 +1,50 @@
+/**This library paints the free SRAM at startup, and later counts the
+ * paint the stack has not overwritten.  Nothing uses malloc(), so the
+ * free SRAM runs from _end, just past the static variables, to __stack,
+ * the top of the SRAM.
+ */
+#include <avr/io.h>
+#include "stackcheck.h"
+
+extern unsigned char _end;
+extern unsigned char __stack;
+
+/**Runs from the .init1 section, before the C runtime has set up r1 or
+ * cleared the static variables, so it is written in assembly and uses
+ * no stack.  The paint stops at __stack, and the reset vector has left
+ * nothing on the stack to paint over.
+ */
+void paintStack() __attribute__((naked, used, section(".init1")));
+void paintStack()
+{
+  __asm__ __volatile__(
+    "  ldi r30,lo8(_end)\n"
+    "  ldi r31,hi8(_end)\n"
+    "  ldi r24,%0\n"
+    "  ldi r25,hi8(__stack)\n"
+    "  rjmp 2f\n"
+    "1:\n"
+    "  st Z+,r24\n"
+    "2:\n"
+    "  cpi r30,lo8(__stack)\n"
+    "  cpc r31,r25\n"
+    "  brlo 1b\n"
+    "  breq 1b\n"
+    ::"M"(STACK_CANARY));
+}
+
+unsigned int stackUnused()
+{
+  const unsigned char* p=&_end;
+  while(p<=&__stack && *p==STACK_CANARY) p++;
+  return p-&_end;
+}
+
+unsigned int stackHighWater()
+  {return (&__stack-&_end+1)-stackUnused();}
+
+unsigned int ramFree()
+{
+  unsigned char top;
+  return &top-&_end;
+}
@@ -0,0 +1,23 @@
+#ifndef stackcheck_h
+#define stackcheck_h
+/**This library measures how much of the SRAM the stack has ever used.
+ * Before main() runs, everything between the end of the static variables
+ * and the top of the stack is painted with STACK_CANARY.  The stack
+ * overwrites the paint as it grows, so the paint left over shows how deep
+ * it has ever been, interrupt frames included.
+ */
+
+//The byte the free SRAM is painted with
+#define STACK_CANARY 0xC5
+
+//Returns the most bytes of stack that have been in use at once
+unsigned int stackHighWater();
+
+//Returns the bytes of painted SRAM the stack has never reached, which
+//is how close the stack has come to the static variables
+unsigned int stackUnused();
+
+//Returns the bytes between the static variables and the stack pointer
+unsigned int ramFree();
+
+#endif
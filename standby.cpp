@@ -0,0 +1,68 @@
+/**This library sleeps in power down.  In power down every clock stops, so
+ * only a level on INT0 or a pin change can wake the ATmega.  The button
+ * already has a pin change interrupt, which posts its press as it wakes
+ * the robot, so it only has to be left on.  The IMU's INT is wired to
+ * INT0, which is turned on only while asleep.
+ */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "standby.h"
+#include "accelerometer.h"
+#include "analog.h"
+#include "voice.h"
+
+/**The IMU holds INT low until it is read, so the interrupt turns itself
+ * off, or it would run again as soon as it returned
+ */
+ISR(INT0_vect)
+  {EIMSK&=~(1<<INT0);}
+
+/**The timers would stop with the clock anyway, but stopping them first
+ * keeps their interrupts from running while the rest is turned off and
+ * on, and leaves the clock and the servo frame to carry on from where
+ * they were
+ */
+void standby()
+{
+  accelSleep();
+  voiceSleep();
+  analogSleep();
+  //The analog comparator is on from reset, and draws current in sleep
+  ACSR|=(1<<ACD);
+
+  unsigned char timer0=TCCR0B;
+  unsigned char timer1=TCCR1B;
+  unsigned char timer2=TCCR2B;
+  TCCR0B=timer0&~STANDBY_TIMER_CLOCK;
+  TCCR1B=timer1&~STANDBY_TIMER_CLOCK;
+  TCCR2B=timer2&~STANDBY_TIMER_CLOCK;
+
+  //The pull up keeps INT0 high if the IMU isn't fitted.  A low level
+  //interrupt is the only kind that works in power down
+  DDRD&=~STANDBY_IMU_INT;
+  PORTD|=STANDBY_IMU_INT;
+  EICRA&=~((1<<ISC01)|(1<<ISC00));
+  EIFR=(1<<INTF0);
+  EIMSK|=(1<<INT0);
+
+  //The brown out detector is turned off for the sleep too, which must be
+  //done just before it.  sei() lets one more instruction run before any
+  //interrupt, so a wake up that is already waiting can't be slept through
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  cli();
+  sleep_enable();
+  sleep_bod_disable();
+  sei();
+  sleep_cpu();
+  sleep_disable();
+  EIMSK&=~(1<<INT0);
+
+  TCCR1B=timer1;
+  TCCR2B=timer2;
+  TCCR0B=timer0;
+  ACSR&=~(1<<ACD);
+  setUpAnalog();
+  voiceWake();
+  accelWake();
+}
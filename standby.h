@@ -0,0 +1,23 @@
+#ifndef standby_h
+#define standby_h
+/**This library puts the robot into the ATmega's power down sleep, the
+ * deepest it has, while it is left alone.  Everything that draws current is
+ * turned off first: the ADC, the sound board, the timers and most of the
+ * IMU.  A press of the button, or the IMU feeling the robot move, wakes it.
+ * The millisecond clock doesn't count the time asleep.
+ */
+
+//The IMU's INT pin, on port D2 (INT0)
+#define STANDBY_IMU_INT 0x04
+
+//The clock select bits, which are the low three bits of TCCR0B, TCCR1B and
+//TCCR2B.  Clearing them stops the timer where it is
+#define STANDBY_TIMER_CLOCK 0x07
+
+//Sleeps until the button is pressed or the robot is moved, then turns
+//everything on again and returns.  The ticks are running again at once,
+//and the IMU is read again within its set up (about 30 milliseconds).
+//The servos must already be detached (see servosDetached())
+void standby();
+
+#endif
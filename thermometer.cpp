@@ -1,88 +1,126 @@
 /**This library is written to interface with a temperature sensor which produces
  * an analogue signal which is inversely proportional to the temperature.  The
- * signal is read through the ATMega328's ADC on pin ADC0
+ * signal is read through the ATMega328's ADC by the analog scanner, or, with
+ * THERM_IMU, taken from the IMU by the accelerometer
  */
-#include <avr/io.h>
+#include <util/atomic.h>
+#include "analog.h"
 #include "thermometer.h"
+#include "events.h"
+#include "fsm.h"
+#include "clock.h"
+#include "settings.h"
 
-/**Configure the ADC to read the temperature's analog signal
+/**Each decimated reading from the analog scanner is summed over
+ * THERM_WINDOW readings, and the difference between two consecutive windows
+ * is the rate of change used by thermTick().  This is called from the ADC
+ * interrupt, so all of this integer math is done off the main loop.
  */
-void setUpTemperature()
+static unsigned int windowSum;
+static unsigned char windowCount;
+static unsigned int lastWindowSum;
+
+static volatile int thermSlope;
+
+void thermSample(unsigned int reading)
+{
+  windowSum+=reading;
+  if(++windowCount<THERM_WINDOW) return;
+  //The voltage falls as the temperature rises, so warming is positive
+  if(lastWindowSum) thermSlope=(int)(lastWindowSum-windowSum);
+  lastWindowSum=windowSum;
+  windowSum=0;
+  windowCount=0;
+}
+
+#ifdef THERM_IMU
+
+static volatile unsigned int imuReading;
+
+/**Averages THERM_IMU_DIVISOR readings into one decimated reading.  The IMU
+ * reading rises with the temperature, so it is turned upside down to fall
+ * like the analog sensor's voltage, and the rest of the library is the same
+ * for both.
+ */
+void thermImuSample(int raw)
+{
+  static long imuSum;
+  static unsigned char imuCount;
+  imuSum+=raw;
+  if(++imuCount<THERM_IMU_DIVISOR) return;
+  int average=imuSum/THERM_IMU_DIVISOR;
+  imuSum=0;
+  imuCount=0;
+  unsigned int reading=(0x8000>>THERM_IMU_SHIFT)-(average>>THERM_IMU_SHIFT);
+  imuReading=reading;
+  thermSample(reading);
+}
+
+/**Returns the decimated IMU reading, which falls as the temperature rises
+ */
+unsigned int temperature()
 {
-  //Set REFS1 and REFS0 to 0 and 1 respectively so it will use AREF
-  ADMUX|=1<<REFS0;
-  //Select ADC0 input, and enable the pin as input
-  ADMUX|=1<<MUX0;
-  DDRC &= 0xFE;
-  //Enable the ADC
-  ADCSRA|=1<<ADEN;
-  //Set ADC refresh frequency to 125kHz
-  ADCSRA|=(1<<ADPS2)|(1<<ADPS1)|(1<<ADPS0);
-  //Set free running mode, so individual measurements don't need to be made
-  ADCSRB|=(1<<ADTS2)|(1<<ADTS1)|(1<<ADTS0);
-  //Begin Measuring
-  ADCSRA|=(1<<ADSC);
+  unsigned int reading;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){reading=imuReading;}
+  return reading;
 }
 
-/**Returns a oltage which is inversely proportional to the temperature
+#else
+
+/**Returns a voltage which is inversely proportional to the temperature.
+ * This is the decimated reading, so it is 10+THERM_EXTRA_BITS bits wide
  */
-int temperature()
-  {return ADC;}
-  
-  
+unsigned int temperature()
+  {return analogRead(ANALOG_TEMPERATURE);}
 
+#endif
 
+/**Returns how much the temperature rose between the last two windows of
+ * decimated readings, in the units of temperature() times THERM_WINDOW
+ */
+int warmingRate()
+{
+  int slope;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){slope=thermSlope;}
+  return slope;
+}
 
 int handHeld;
 
 int holdingHand(){return handHeld;}
 
 enum therm_ST {init_THERMOMETER,waitForStart_THERMOMETER,delayForNextSense_THERMOMETER};
-void thermTick()
+
+static unsigned int delayStart;
+
+static int warming(){return warmingRate()>=settings.warmingRate;}
+static int delayDone(){return clockElapsed(delayStart,THERM_DELAY_MS);}
+
+static void reportHand()
 {
-  static therm_ST state=init_THERMOMETER;
-  static int delayCounter;
-  switch(state)
-  {
-    case init_THERMOMETER:
-      handHeld=0;
-      delayCounter=0;
-      state=waitForStart_THERMOMETER;
-      break;
-    case waitForStart_THERMOMETER:
-      if(temperature()>0)
-      {
-        state=delayForNextSense_THERMOMETER;
-        handHeld=1;
-      }
-      else handHeld=0;
-      break;
-    case delayForNextSense_THERMOMETER:
-      //Because the tick function should 60 times a second, counting to
-      //160 gives a 2.5 second delay
-      if(delayCounter>160)
-      {
-        state=waitForStart_THERMOMETER;
-        delayCounter=0;
-      }
-      break;
-    default:
-      break;
-  }
-  switch(state)
-  {
-    case init_THERMOMETER:
-      break;
-    case waitForStart_THERMOMETER:
-      break;
-    case delayForNextSense_THERMOMETER:
-      delayCounter++;
-      break;
-    default:
-      break;
-  }
+  handHeld=1;
+  delayStart=clockNow();
+  postEvent(&taskEvents,HAND_EVENT,0);
 }
 
+static void clearHand(){handHeld=0;}
 
+constexpr fsmTransition thermTransitions[] PROGMEM=
+{
+  FSM_ROW(init_THERMOMETER,              0,         clearHand,  waitForStart_THERMOMETER),
+  FSM_ROW(waitForStart_THERMOMETER,      warming,   reportHand, delayForNextSense_THERMOMETER),
+  FSM_ROW(waitForStart_THERMOMETER,      0,         clearHand,  waitForStart_THERMOMETER),
+  FSM_ROW(delayForNextSense_THERMOMETER, delayDone, 0,          waitForStart_THERMOMETER),
+};
+constexpr fsmAction thermActions[] PROGMEM={0,0,0};
+#ifdef FSM_EXPORT
+const char* const thermNames[]={"init","waitForStart","delayForNextSense"};
+#endif
+FSM_CHECK(therm);
+FSM_MACHINE(therm);
 
-
+void thermTick()
+{
+  static unsigned char state=init_THERMOMETER;
+  state=fsmStep(&thermMachine,state);
+}
@@ -1,13 +1,62 @@
 /**This library is written to interface with a temperature sensor which produces
  * an analogue signal which is inversely proportional to the temperature.  The
- * signal is read through the ATMega328's ADC on pin ADC0
+ * signal is read through the ATMega328's ADC by the analog scanner in
+ * analog.cpp, which oversamples it by THERM_EXTRA_BITS.
+ *
+ * With THERM_IMU defined, the temperature is instead taken from the GY-521's
+ * own sensor, which is read in the same burst as the accelerometer axes, and
+ * the ADC input is left free.
  */
+#include "posture.h"
 
-//Configure the ADC to read the temperature's analog signal
-void setUpTemperature();
+//The extra bits of resolution the scanner's oversampling gives the
+//temperature channel (this must match its entry in analogChannels[])
+#define THERM_EXTRA_BITS 2
 
-//Returns a oltage which is inversely proportional to the temperature
-int temperature();
+//With THERM_IMU, the number of IMU readings averaged into each decimated
+//reading, and the bits dropped from the average.  The IMU gives 1/340 of a
+//degree per bit, so dropping 4 bits leaves about 1/21 of a degree, and a
+//range that fits the 12 bits of the analog reading
+#define THERM_IMU_DIVISOR 8
+#define THERM_IMU_SHIFT 4
+
+//The number of decimated readings summed before the rate of change is found
+#define THERM_WINDOW 16
+
+//The default rise in the window sum that counts as a hand warming the
+//sensor.  The value in use is kept in the settings
+#ifndef THERM_IMU
+#define THERM_WARMING_RATE 24
+#else
+#define THERM_WARMING_RATE THERM_IMU_WARMING_RATE
+#endif
+
+//With THERM_IMU, the warming that counts as a hand, in hundredths of a
+//degree per second, and the rise in the window sum it comes to.  A
+//decimated reading is 340>>THERM_IMU_SHIFT (about 21) to the degree, and
+//the windows are THERM_IMU_WINDOW_MS apart, about 2s against the analog
+//scan's 0.8s, so the analog default doesn't carry over
+#define THERM_IMU_HAND_RATE 5
+#define THERM_IMU_WINDOW_MS (THERM_WINDOW*THERM_IMU_DIVISOR*(long)POSTURE_PERIOD_MS)
+#define THERM_IMU_WARMING_RATE ((int)(THERM_IMU_HAND_RATE*THERM_WINDOW*340L* \
+  THERM_IMU_WINDOW_MS/(100L*1000*(1<<THERM_IMU_SHIFT))))
+
+//How long to wait after a hand is noticed before looking for another,
+//in milliseconds
+#define THERM_DELAY_MS 2500
+
+//Accumulates a decimated reading.  Called by the ADC interrupt
+void thermSample(unsigned int reading);
+
+//Accumulates a raw TEMP_OUT reading from the IMU.  Called by the
+//accelerometer after each burst, when THERM_IMU is defined
+void thermImuSample(int raw);
+
+//Returns a voltage which is inversely proportional to the temperature
+unsigned int temperature();
+
+//Returns how fast the temperature is rising (positive while warming)
+int warmingRate();
 
 //Returns 1 if the thermometer in the hand is warming up, 0 otherwise
 int holdingHand();
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Encodes sound clips as 4-bit IMA ADPCM and writes clips.h/clips.cpp.
+
+Each argument is a mono 16-bit WAV file recorded at the engine's sample
+rate (AUDIO_SAMPLE_RATE in audio.h).  The clips are numbered in the order
+given, which is the track number used by playTrack().  With no arguments
+a set of short placeholder tones is generated instead, one per track
+defined in voice.h.
+
+    tools/adpcm.py accel.wav button.wav temperature.wav
+"""
+import math
+import sys
+import wave
+
+RATE = 8000
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+    209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724,
+    796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272,
+    2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132,
+    7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500,
+    20350, 22385, 24623, 27086, 29794, 32767]
+INDEX = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def encode(samples):
+    """Returns the ADPCM bytes, low nibble first, starting from a
+    predictor and step index of 0 like the decoder in audio.cpp."""
+    predictor, index = 0, 0
+    nibbles = []
+    for sample in samples:
+        step = STEPS[index]
+        delta = sample - predictor
+        nibble = 8 if delta < 0 else 0
+        delta = abs(delta)
+        diff = step >> 3
+        for bit, part in ((4, step), (2, step >> 1), (1, step >> 2)):
+            if delta >= part:
+                nibble |= bit
+                delta -= part
+                diff += part
+        predictor += -diff if nibble & 8 else diff
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + INDEX[nibble & 7]))
+        nibbles.append(nibble)
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    return bytes(nibbles[i] | nibbles[i + 1] << 4
+                 for i in range(0, len(nibbles), 2))
+
+
+def read_wav(path):
+    with wave.open(path) as w:
+        if w.getnchannels() != 1 or w.getsampwidth() != 2:
+            sys.exit(path + ": expected mono 16-bit samples")
+        if w.getframerate() != RATE:
+            sys.exit("%s: expected %d Hz" % (path, RATE))
+        raw = w.readframes(w.getnframes())
+    return [int.from_bytes(raw[i:i + 2], "little", signed=True)
+            for i in range(0, len(raw), 2)]
+
+
+def tone(start, end, seconds, warble=0):
+    """A sine sweep from start to end Hz that fades out."""
+    n = int(RATE * seconds)
+    phase, out = 0.0, []
+    for i in range(n):
+        f = start + (end - start) * i / n
+        f += warble * math.sin(2 * math.pi * 12 * i / RATE)
+        phase += 2 * math.pi * f / RATE
+        out.append(int(20000 * (1 - i / n) * math.sin(phase)))
+    return out
+
+
+def main(paths):
+    if paths:
+        clips = [(p.rsplit("/", 1)[-1], read_wav(p)) for p in paths]
+    else:
+        clips = [("accelerometer (placeholder)", tone(300, 900, 0.3)),
+                 ("button (placeholder)", tone(1200, 1200, 0.15)),
+                 ("temperature (placeholder)", tone(600, 600, 0.3, 80))]
+    with open("clips.h", "w") as h:
+        h.write("//Generated by tools/adpcm.py.  Do not edit.\n")
+        h.write("#ifndef clips_h\n#define clips_h\n")
+        h.write('#include "audio.h"\n\n')
+        h.write("#define AUDIO_CLIPS %d\n\n" % len(clips))
+        h.write("extern const audioClip audioClips[AUDIO_CLIPS];\n\n#endif\n")
+    with open("clips.cpp", "w") as c:
+        c.write("/**Generated by tools/adpcm.py.  Do not edit.\n")
+        c.write(" * 4-bit IMA ADPCM clips at %d Hz, low nibble first.\n */\n" % RATE)
+        c.write('#include <avr/pgmspace.h>\n#include "clips.h"\n')
+        for n, (name, samples) in enumerate(clips):
+            data = encode(samples)
+            c.write("\n//Clip %d: %s\n" % (n, name))
+            c.write("static const unsigned char clip%d[%d] PROGMEM=\n{\n" % (n, len(data)))
+            for i in range(0, len(data), 16):
+                c.write("  " + ",".join("0x%02X" % b for b in data[i:i + 16]) + ",\n")
+            c.write("};\n")
+        c.write("\nconst audioClip audioClips[AUDIO_CLIPS] PROGMEM=\n{\n")
+        for n, (name, samples) in enumerate(clips):
+            c.write("  {clip%d,sizeof(clip%d)},\n" % (n, n))
+        c.write("};\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
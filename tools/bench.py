@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Runs the cycle counting benchmarks (see bench.h) under simavr.
+
+The firmware is built with BENCH defined and run on a simulated ATmega328P
+at the real clock speed.  The BENCH lines it writes to the UART are
+collected into a JSON report of cycles for each benchmark.
+
+    tools/bench.py                              print the report
+    tools/bench.py -DASSET_STORE                build with a feature flag
+    tools/bench.py --save bench-baseline.json   also save it as a baseline
+    tools/bench.py --compare bench-baseline.json
+                                                fail if any mean is more
+                                                than --tolerance percent
+                                                slower than the baseline
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+import memreport
+
+# Simulated seconds are far slower than real ones, and the I2C reads wait
+# on the bus, so allow plenty of time
+TIMEOUT = 300
+
+LINE = re.compile(r"BENCH (\w+) (\d+) (\d+) (\d+)")
+DONE = re.compile(r"BENCH_DONE (\d+)")
+
+
+def run(elf):
+    cmd = ["simavr", "-m", memreport.MCU, "-f", str(int(memreport.F_CPU.rstrip("UL"))), elf]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True, timeout=TIMEOUT)
+    report = {}
+    stack = None
+    for line in result.stdout.split("\n"):
+        match = LINE.search(line)
+        if match:
+            name, least, most, mean = match.groups()
+            report[name] = {"min": int(least), "max": int(most), "mean": int(mean)}
+        match = DONE.search(line)
+        if match:
+            stack = int(match.group(1))
+    if stack is None:
+        sys.exit("the benchmarks did not finish:\n" + result.stdout)
+    return {"cycles": report, "stack": stack}
+
+
+def compare(report, baseline, tolerance):
+    """Prints the change from the baseline, and returns the regressions"""
+    slower = []
+    for name, cycles in sorted(report["cycles"].items()):
+        old = baseline["cycles"].get(name)
+        if not old:
+            print("%-18s %7d  (new)" % (name, cycles["mean"]))
+            continue
+        change = 100.0 * (cycles["mean"] - old["mean"]) / max(old["mean"], 1)
+        print("%-18s %7d  %+6.1f%%" % (name, cycles["mean"], change))
+        if change > tolerance:
+            slower.append(name)
+    print("%-18s %7d  (was %d)" % ("stack", report["stack"], baseline["stack"]))
+    return slower
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-D", dest="defines", action="append", default=[],
+                        metavar="FLAG", help="define a feature flag")
+    parser.add_argument("--save", metavar="FILE")
+    parser.add_argument("--compare", metavar="FILE")
+    parser.add_argument("--tolerance", type=float, default=2.0,
+                        help="percent slowdown allowed by --compare")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    defines = ["-DBENCH"] + ["-D" + d for d in args.defines]
+    with tempfile.TemporaryDirectory() as build_dir:
+        try:
+            memreport.build(root, build_dir, defines)
+            report = run(os.path.join(build_dir, "firmware.elf"))
+        except (OSError, subprocess.CalledProcessError, subprocess.TimeoutExpired) as e:
+            sys.exit("benchmark failed: %s" % e)
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(report, f, indent=1, sort_keys=True)
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+        slower = compare(report, baseline, args.tolerance)
+        if slower:
+            sys.exit("slower than the baseline: " + ", ".join(slower))
+    else:
+        json.dump(report, sys.stdout, indent=1, sort_keys=True)
+        print()
+
+
+if __name__ == "__main__":
+    main()
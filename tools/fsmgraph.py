@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Draws the firmware's state machines (see fsm.h) as Graphviz graphs.
+
+The firmware is built with FSM_EXPORT defined and run under simavr, and
+each graph it writes to the UART (see fsmexport.h) is saved as
+<name>.dot, ready for dot -Tpng.
+
+    tools/fsmgraph.py                   write the graphs here
+    tools/fsmgraph.py -o docs/fsm       write them to another directory
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+import memreport
+
+TIMEOUT = 60
+
+BEGIN = re.compile(r"^digraph (\w+) \{$")
+
+
+def run(elf):
+    cmd = ["simavr", "-m", memreport.MCU, "-f", str(int(memreport.F_CPU.rstrip("UL"))), elf]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True, timeout=TIMEOUT)
+    graphs = {}
+    name = None
+    done = False
+    for line in result.stdout.split("\n"):
+        match = BEGIN.search(line)
+        if match:
+            name = match.group(1)
+            graphs[name] = []
+        if name:
+            graphs[name].append(line)
+            if line == "}":
+                name = None
+        if line.endswith("FSM_DONE"):
+            done = True
+    if not done:
+        sys.exit("the graphs were not all written:\n" + result.stdout)
+    return graphs
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-o", "--output", default=".", help="the directory for the graphs")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    with tempfile.TemporaryDirectory() as build_dir:
+        try:
+            memreport.build(root, build_dir, ["-DFSM_EXPORT"])
+            graphs = run(os.path.join(build_dir, "firmware.elf"))
+        except (OSError, subprocess.CalledProcessError, subprocess.TimeoutExpired) as e:
+            sys.exit("export failed: %s" % e)
+
+    os.makedirs(args.output, exist_ok=True)
+    for name, lines in sorted(graphs.items()):
+        path = os.path.join(args.output, name + ".dot")
+        with open(path, "w") as f:
+            f.write("\n".join(lines) + "\n")
+        print(path)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Reports the flash and static RAM each module takes in the firmware image.
+
+Every source is compiled with avr-gcc and linked with unused sections
+removed, as the firmware is built, and the linker map is read to find what
+each object file kept.  Flash is code, constant tables and the initial
+values of .data; RAM is .data, .bss and .noinit.  The stack and what it has
+used at run time are not included (see stackcheck.h).
+
+    tools/memreport.py                    print the table
+    tools/memreport.py -DASSET_STORE      build with a feature flag
+    tools/memreport.py --save mem.json    also save the numbers
+    tools/memreport.py --compare mem.json show the change since a save
+"""
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+MCU = "atmega328p"
+F_CPU = "1000000UL"
+SRAM = 2048
+FLASH = 32768
+
+CFLAGS = ["-mmcu=" + MCU, "-DF_CPU=" + F_CPU, "-Os",
+          "-ffunction-sections", "-fdata-sections"]
+CXXFLAGS = CFLAGS + ["-std=gnu++11", "-fno-exceptions", "-fno-rtti"]
+
+FLASH_SECTIONS = re.compile(r"^\.(text|progmem|data|rodata)")
+RAM_SECTIONS = re.compile(r"^\.(data|bss|noinit)")
+
+
+def sources(root):
+    files = sorted(glob.glob(os.path.join(root, "*.cpp")) +
+                   glob.glob(os.path.join(root, "*.c")))
+    return files + [os.path.join(root, "mickeyMouse.ino")]
+
+
+def build(root, build_dir, defines):
+    objects = []
+    for src in sources(root):
+        name = os.path.basename(src)
+        obj = os.path.join(build_dir, os.path.splitext(name)[0] + ".o")
+        if src.endswith(".c"):
+            cmd = ["avr-gcc"] + CFLAGS
+        elif src.endswith(".ino"):
+            cmd = ["avr-g++"] + CXXFLAGS + ["-x", "c++"]
+        else:
+            cmd = ["avr-g++"] + CXXFLAGS
+        subprocess.check_call(cmd + defines + ["-I", root, "-c", src, "-o", obj])
+        objects.append(obj)
+    elf = os.path.join(build_dir, "firmware.elf")
+    mapfile = os.path.join(build_dir, "firmware.map")
+    subprocess.check_call(["avr-gcc", "-mmcu=" + MCU, "-Wl,--gc-sections",
+                           "-Wl,-Map=" + mapfile, "-o", elf] + objects)
+    return mapfile
+
+
+def read_map(mapfile):
+    """Returns {module: [flash, ram]} for the sections the linker kept"""
+    sizes = {}
+    with open(mapfile) as f:
+        lines = f.read().split("\n")
+    # Only the memory map lists kept sections; the list before it is of
+    # discarded ones
+    start = next(i for i, l in enumerate(lines) if l.startswith("Linker script and memory map"))
+    section = None
+    for line in lines[start:]:
+        fields = line.split()
+        if line.startswith(" .") or line.startswith(" COMMON"):
+            section = fields[0]
+            fields = fields[1:]
+        elif not line.startswith("   "):
+            section = None
+            continue
+        if section is None or len(fields) != 3 or not fields[0].startswith("0x"):
+            continue
+        size = int(fields[1], 16)
+        path = fields[2]
+        if not path.endswith(".o") or not size:
+            continue
+        module = os.path.splitext(os.path.basename(path))[0]
+        entry = sizes.setdefault(module, [0, 0])
+        if section == "COMMON":
+            entry[1] += size
+            continue
+        if FLASH_SECTIONS.match(section):
+            entry[0] += size
+        if RAM_SECTIONS.match(section):
+            entry[1] += size
+        section = None
+    return sizes
+
+
+def report(sizes, baseline):
+    print("%-16s %7s %7s" % ("module", "flash", "ram") +
+          ("  %7s %7s" % ("+flash", "+ram") if baseline else ""))
+    total = [0, 0]
+    for module in sorted(sizes):
+        flash, ram = sizes[module]
+        total[0] += flash
+        total[1] += ram
+        line = "%-16s %7d %7d" % (module, flash, ram)
+        if baseline:
+            old = baseline.get(module, [0, 0])
+            line += "  %+7d %+7d" % (flash - old[0], ram - old[1])
+        print(line)
+    print("%-16s %7d %7d" % ("total", total[0], total[1]))
+    print("of %d flash and %d SRAM; %d SRAM left for the stack"
+          % (FLASH, SRAM, SRAM - total[1]))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-D", dest="defines", action="append", default=[],
+                        metavar="FLAG", help="define a feature flag")
+    parser.add_argument("--save", metavar="FILE")
+    parser.add_argument("--compare", metavar="FILE")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    with tempfile.TemporaryDirectory() as build_dir:
+        try:
+            mapfile = build(root, build_dir, ["-D" + d for d in args.defines])
+        except (OSError, subprocess.CalledProcessError) as e:
+            sys.exit("build failed: %s" % e)
+        sizes = read_map(mapfile)
+
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+    report(sizes, baseline)
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(sizes, f, indent=1, sort_keys=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Builds an image for the SPI flash asset store (see assets.h).
+
+Each argument is NAME=FILE.  WAV files are encoded as IMA ADPCM for the
+audio engine (see tools/adpcm.py); any other file is stored as it is.
+Blobs start on 256 byte flash pages.
+
+    tools/mkassets.py -o assets.bin TRACK03=hello.wav WAVE=wave.anim
+"""
+import argparse
+import struct
+import sys
+
+import adpcm
+
+PAGE = 256
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-o", "--output", default="assets.bin")
+    parser.add_argument("blobs", nargs="+", metavar="NAME=FILE")
+    args = parser.parse_args()
+
+    blobs = []
+    for spec in args.blobs:
+        name, _, path = spec.partition("=")
+        if not path or len(name) > 8:
+            sys.exit("%s: expected NAME=FILE with a name of up to 8 characters" % spec)
+        if path.lower().endswith(".wav"):
+            data = adpcm.encode(adpcm.read_wav(path))
+        else:
+            with open(path, "rb") as f:
+                data = f.read()
+        blobs.append((name.encode(), data))
+
+    directory = b"MMAS" + struct.pack("<HH", len(blobs), 0)
+    address = -(-(len(directory) + 16 * len(blobs)) // PAGE) * PAGE
+    body = b""
+    for name, data in blobs:
+        directory += name.ljust(8, b"\0") + struct.pack("<II", address + len(body), len(data))
+        body += data + b"\xff" * (-len(data) % PAGE)
+    image = directory.ljust(address, b"\xff") + body
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+
+if __name__ == "__main__":
+    main()
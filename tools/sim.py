@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Runs the firmware in the full system simulation (see sim/mmsim.c).
+
+The firmware is built as it is for the robot, the simulation is built
+against simavr, and the firmware is run for a while with the inputs from a
+script.  The JSON report of latencies, boot phase times, servo pulses
+(and how long each servo was detached), standby sleeps and wake times, and
+CPU load is printed.
+
+    tools/sim.py                            run sim/shake.script for 20s
+    tools/sim.py -s sim/standby.script -t 200000
+                                            let it go to sleep, and wake it
+    tools/sim.py -DASSET_STORE              build with a feature flag
+    tools/sim.py -s my.script -t 60000      another script, for a minute
+"""
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+import memreport
+
+
+# The functions the main loop's idle spin runs, as linked (C++ names are
+# mangled): main, myLoop() and servoFrame()
+IDLE_FUNCTIONS = ["main", "_Z6myLoopv", "_Z10servoFramev"]
+
+
+def symbol(elf, name):
+    """Returns the address of a symbol in the firmware, or None"""
+    out = subprocess.check_output(["avr-nm", elf], universal_newlines=True)
+    for line in out.split("\n"):
+        fields = line.split()
+        if len(fields) == 3 and fields[2] == name:
+            return int(fields[0], 16)
+    return None
+
+
+def extent(elf, name):
+    """Returns the start and end addresses of a function, or None"""
+    out = subprocess.check_output(["avr-nm", "-S", elf], universal_newlines=True)
+    for line in out.split("\n"):
+        fields = line.split()
+        if len(fields) == 4 and fields[3] == name:
+            start = int(fields[0], 16)
+            return start, start + int(fields[1], 16)
+    return None
+
+
+def build_sim(root, build_dir):
+    sim = os.path.join(build_dir, "mmsim")
+    flags = subprocess.check_output(["pkg-config", "--cflags", "--libs", "simavr"],
+                                    universal_newlines=True).split()
+    sources = [os.path.join(root, "sim", f) for f in ("mmsim.c", "mpu6050.c")]
+    subprocess.check_call(["cc", "-O2", "-std=gnu99", "-o", sim] + sources + flags + ["-lelf"])
+    return sim
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-D", dest="defines", action="append", default=[],
+                        metavar="FLAG", help="define a feature flag")
+    parser.add_argument("-s", "--script", help="the script of inputs")
+    parser.add_argument("-t", "--ms", type=int, default=20000,
+                        help="simulated milliseconds to run")
+    parser.add_argument("-p", "--play-ms", type=int, default=1000,
+                        help="how long the virtual sound board plays a track")
+    parser.add_argument("-i", "--hold-ma", type=int, default=100,
+                        help="one servo's holding current, to estimate the saving")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    script = args.script or os.path.join(root, "sim", "shake.script")
+    with tempfile.TemporaryDirectory() as build_dir:
+        try:
+            memreport.build(root, build_dir, ["-D" + d for d in args.defines])
+            elf = os.path.join(build_dir, "firmware.elf")
+            sim = build_sim(root, build_dir)
+            cmd = [sim, "-s", script, "-t", str(args.ms), "-p", str(args.play_ms),
+                   "-i", str(args.hold_ma)]
+            ticks_due = symbol(elf, "ticksDue")
+            if ticks_due is not None:
+                cmd += ["-b", hex(ticks_due)]
+            boot_times = symbol(elf, "bootTimes")
+            if boot_times is not None:
+                cmd += ["-B", hex(boot_times)]
+            for name in IDLE_FUNCTIONS:
+                code = extent(elf, name)
+                if code is not None:
+                    cmd += ["-l", "%#x:%#x" % code]
+            result = subprocess.run(cmd + [elf])
+        except (OSError, subprocess.CalledProcessError) as e:
+            sys.exit("simulation failed: %s" % e)
+    sys.exit(result.returncode)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Tests the asset store (see assets.h) on the host.
+
+An image is built with tools/mkassets.py from blobs of known bytes, and
+assets.cpp is compiled with the host stand-in for the flash (SPIFLASH_IMAGE
+in spiflash.h).  Every blob is read back through openAsset() and
+assetByte() and compared with what went in, and a missing name must not
+open.  There are more blobs than the directory index holds, so both ways
+of finding an entry are used.
+
+    tools/test_assets.py
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+# More than ASSET_INDEX in assets.h
+BLOBS = 80
+
+DRIVER = r"""
+#include <stdio.h>
+#include "assets.h"
+
+int main(int argc, char** argv)
+{
+  setUpAssets();
+  printf("%u\n", assetCount());
+  for(int i=1;i<argc;i++)
+  {
+    assetStream stream;
+    if(!openAsset(argv[i],&stream))
+    {
+      printf("%s missing\n", argv[i]);
+      continue;
+    }
+    printf("%s", argv[i]);
+    while(!assetEnd(&stream))
+    {
+      int byte=assetByte(&stream);
+      if(byte<0) return 1;
+      printf(" %d", byte);
+    }
+    closeAsset(&stream);
+    printf("\n");
+  }
+  return 0;
+}
+"""
+
+
+def blob(i):
+    """Known bytes, of lengths that end inside, on and past a cache line"""
+    return bytes((i * 7 + n * 13) & 0xFF for n in range(i * 5 % 200 + 1))
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    names = ["B%d" % i for i in range(BLOBS - 1)] + ["LONGNAME"]
+    with tempfile.TemporaryDirectory() as tmp:
+        specs = []
+        for i, name in enumerate(names):
+            path = os.path.join(tmp, name + ".bin")
+            with open(path, "wb") as f:
+                f.write(blob(i))
+            specs.append("%s=%s" % (name, path))
+        image = os.path.join(tmp, "assets.bin")
+        subprocess.check_call([sys.executable, os.path.join(root, "tools", "mkassets.py"),
+                               "-o", image] + specs)
+
+        driver = os.path.join(tmp, "driver.cpp")
+        with open(driver, "w") as f:
+            f.write(DRIVER)
+        exe = os.path.join(tmp, "driver")
+        subprocess.check_call(["c++", "-Wall", "-I", root, '-DSPIFLASH_IMAGE="%s"' % image,
+                               "-o", exe, driver, os.path.join(root, "assets.cpp"),
+                               os.path.join(root, "spiflash.cpp")])
+        asked = names[::-1] + ["NOTHERE", "B1X"]
+        out = subprocess.check_output([exe] + asked, universal_newlines=True).split("\n")
+
+    failures = 0
+    if out[0] != str(len(names)):
+        print("count: %s, expected %d" % (out[0], len(names)))
+        failures += 1
+    for name, line in zip(asked, out[1:]):
+        if name in names:
+            expected = " ".join([name] + [str(b) for b in blob(names.index(name))])
+        else:
+            expected = name + " missing"
+        if line != expected:
+            print("%s: read %s" % (name, line[:60]))
+            failures += 1
+    print("%d blobs, %d failures" % (len(names), failures))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
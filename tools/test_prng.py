@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Tests the pseudorandom number generator (see prng.h) on the host.
+
+prng.cpp is compiled for the host against stand-ins for the AVR headers.
+The xorshift generator is stepped through its whole period from a state of
+1, which must visit every other state once and never reach 0, the state it
+could not leave.  A full period of draws through randomChoice() is then
+made over a few weight tables, and each choice must come up in proportion
+to its weight.
+
+    tools/test_prng.py
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+# How far a choice may come up from its share of the draws, as a fraction
+# of the draws.  Scaling a byte to the total of the weights is out by at
+# most one byte value in 256 for each choice
+TOLERANCE = 1.0 / 256
+
+WEIGHTS = [
+    [1],
+    [1, 1],
+    [10, 30, 60],
+    [200, 40, 10, 5],
+    [3, 0, 7, 1, 12, 2],
+]
+
+IO_H = r"""
+extern unsigned char ADMUX, ADCSRA;
+extern unsigned int ADC;
+#define REFS0 6
+#define ADEN 7
+#define ADSC 6
+#define ADPS0 0
+"""
+
+PGMSPACE_H = r"""
+#define PROGMEM
+#define pgm_read_byte(p) (*(const unsigned char*)(p))
+"""
+
+DRIVER = r"""
+#include <stdio.h>
+#include "prng.h"
+
+unsigned char ADMUX, ADCSRA;
+unsigned int ADC;
+
+static const unsigned char weights[][8]={%(tables)s};
+static const unsigned char counts[]={%(counts)s};
+
+int main()
+{
+  //The state is the last word drawn
+  unsigned long period=0;
+  unsigned int word;
+  do
+  {
+    word=randomWord();
+    if(!word || word>0xFFFF)
+    {
+      printf("state %%u\n", word);
+      return 1;
+    }
+    period++;
+  } while(word!=1 && period<=0x10000);
+  printf("%%lu\n", period);
+
+  for(unsigned int t=0;t<sizeof(counts);t++)
+  {
+    unsigned long seen[8]={0};
+    for(unsigned long i=0;i<period;i++) seen[randomChoice(weights[t],counts[t])]++;
+    for(unsigned char i=0;i<counts[t];i++) printf("%%lu ", seen[i]);
+    printf("\n");
+  }
+  return 0;
+}
+"""
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    with tempfile.TemporaryDirectory() as tmp:
+        os.mkdir(os.path.join(tmp, "avr"))
+        with open(os.path.join(tmp, "avr", "io.h"), "w") as f:
+            f.write(IO_H)
+        with open(os.path.join(tmp, "avr", "pgmspace.h"), "w") as f:
+            f.write(PGMSPACE_H)
+        driver = os.path.join(tmp, "driver.cpp")
+        with open(driver, "w") as f:
+            f.write(DRIVER % {
+                "tables": ",".join("{%s}" % ",".join(map(str, w)) for w in WEIGHTS),
+                "counts": ",".join(str(len(w)) for w in WEIGHTS)})
+        exe = os.path.join(tmp, "driver")
+        subprocess.check_call(["c++", "-Wall", "-I", tmp, "-I", root, "-o", exe,
+                               driver, os.path.join(root, "prng.cpp")])
+        out = subprocess.run([exe], stdout=subprocess.PIPE, universal_newlines=True)
+    lines = out.stdout.split("\n")
+
+    failures = 0
+    if out.returncode:
+        print("the generator reached %s" % lines[0])
+        sys.exit(1)
+    period = int(lines[0])
+    if period != 65535:
+        print("period %d, expected 65535" % period)
+        failures += 1
+    for weights, line in zip(WEIGHTS, lines[1:]):
+        seen = [int(n) for n in line.split()]
+        total = sum(weights)
+        for i, (weight, count) in enumerate(zip(weights, seen)):
+            expected = period * weight / total
+            if abs(count - expected) > period * TOLERANCE or (not weight and count):
+                print("weights %s: choice %d came up %d times, expected %.0f"
+                      % (weights, i, count, expected))
+                failures += 1
+    print("period %d, %d weight tables, %d failures" % (period, len(WEIGHTS), failures))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -33,26 +33,56 @@
 #endif
 
 #include "twi.h"
+#include <util/delay.h>
+
+#if defined(__AVR_ATmega168__) || defined(__AVR_ATmega8__) || defined(__AVR_ATmega328P__)
+  #define TWI_PORT PORTC
+  #define TWI_DDR DDRC
+  #define TWI_PIN PINC
+  #define TWI_SDA 4
+  #define TWI_SCL 5
+#else
+  #define TWI_PORT PORTD
+  #define TWI_DDR DDRD
+  #define TWI_PIN PIND
+  #define TWI_SDA 1
+  #define TWI_SCL 0
+#endif
+
+// each pass of a wait loop takes about this many cycles.  This is an
+// estimate, from the instructions a loop of a volatile load, a compare and
+// a 32 bit count down should take, not a count from a compiled listing.
+// Too low an estimate only makes a deadline later, never sooner, as does
+// an interrupt, so it leans low; check it against a listing (avr-objdump)
+// if the loops change
+#define TWI_LOOP_CYCLES 18
+#define TWI_LOOPS(us) ((uint32_t)(F_CPU / 1000000UL) * (us) / TWI_LOOP_CYCLES)
 
 static volatile uint8_t twi_state;
 static uint8_t twi_slarw;
 
-static void (*twi_onSlaveTransmit)(void);
-static void (*twi_onSlaveReceive)(uint8_t*, int);
-
-static uint8_t twi_masterBuffer[TWI_BUFFER_LENGTH];
+// master transfers go straight to and from the caller's buffer
+static uint8_t* twi_masterBuffer;
 static volatile uint8_t twi_masterBufferIndex;
 static uint8_t twi_masterBufferLength;
 
+#ifdef TWI_SLAVE
+static void (*twi_onSlaveTransmit)(void);
+static void (*twi_onSlaveReceive)(uint8_t*, int);
+
 static uint8_t twi_txBuffer[TWI_BUFFER_LENGTH];
 static volatile uint8_t twi_txBufferIndex;
 static volatile uint8_t twi_txBufferLength;
 
 static uint8_t twi_rxBuffer[TWI_BUFFER_LENGTH];
 static volatile uint8_t twi_rxBufferIndex;
+#endif
 
 static volatile uint8_t twi_error;
 
+static uint32_t twi_timeoutLoops = TWI_LOOPS(TWI_TIMEOUT_US);
+static volatile twi_errors_t twi_errors;
+
 /* 
  * Function twi_init
  * Desc     readys twi pins and sets twi bitrate
@@ -64,32 +94,142 @@ void twi_init(void)
   // initialize state
   twi_state = TWI_READY;
 
-  #if defined(__AVR_ATmega168__) || defined(__AVR_ATmega8__) || defined(__AVR_ATmega328P__)
-    // activate internal pull-ups for twi
-    // as per note from atmega8 manual pg167
-    sbi(PORTC, 4);
-    sbi(PORTC, 5);
-  #else
-    // activate internal pull-ups for twi
-    // as per note from atmega128 manual pg204
-    sbi(PORTD, 0);
-    sbi(PORTD, 1);
-  #endif
-
-  // initialize twi prescaler and bit rate
-  cbi(TWSR, TWPS0);
-  cbi(TWSR, TWPS1);
-  TWBR = ((CPU_FREQ / TWI_FREQ) - 16) / 2;
-
-  /* twi bit rate formula from atmega128 manual pg 204
-  SCL Frequency = CPU Clock Frequency / (16 + (2 * TWBR))
-  note: TWBR should be 10 or higher for master mode
-  It is 72 for a 16mhz Wiring board with 100kHz TWI */
+  // activate internal pull-ups for twi
+  // as per note from atmega8 manual pg167
+  sbi(TWI_PORT, TWI_SDA);
+  sbi(TWI_PORT, TWI_SCL);
+
+  // initialize twi prescaler and bit rate (see twi.h)
+  TWSR = TWI_PRESCALER;
+  TWBR = TWI_BITRATE;
 
   // enable twi module, acks, and twi interrupt
   TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
 }
 
+/* 
+ * Function twi_setTimeout
+ * Desc     sets how long a transaction may take before it is abandoned
+ * Input    us: the deadline in microseconds
+ * Output   none
+ */
+void twi_setTimeout(uint16_t us)
+{
+  twi_timeoutLoops = TWI_LOOPS(us);
+}
+
+/* 
+ * Function twi_getErrors
+ * Desc     copies the error counters
+ * Input    errors: where to copy them
+ * Output   none
+ */
+void twi_getErrors(twi_errors_t* errors)
+{
+  uint8_t sreg = SREG;
+  cli();
+  *errors = *(twi_errors_t*)&twi_errors;
+  SREG = sreg;
+}
+
+/* 
+ * Function twi_recover
+ * Desc     frees a slave that is holding SDA low, waiting for clocks
+ *          that were lost in a glitch.  SCL is clocked up to nine times
+ *          until SDA is released, then a stop condition is sent.  The
+ *          pins are driven open drain: low, or released to the pull-ups
+ * Input    none
+ * Output   none
+ */
+static void twi_release(uint8_t bit)
+{
+  cbi(TWI_DDR, bit);
+  sbi(TWI_PORT, bit);
+}
+
+static void twi_pullLow(uint8_t bit)
+{
+  cbi(TWI_PORT, bit);
+  sbi(TWI_DDR, bit);
+}
+
+static void twi_recover(void)
+{
+  uint8_t i;
+
+  // take the pins from the twi module
+  TWCR = 0;
+  twi_release(TWI_SDA);
+  twi_release(TWI_SCL);
+  _delay_us(5);
+
+  for(i = 0; i < 9 && !(TWI_PIN & _BV(TWI_SDA)); ++i){
+    twi_pullLow(TWI_SCL);
+    _delay_us(5);
+    twi_release(TWI_SCL);
+    _delay_us(5);
+  }
+
+  // stop: SDA rises while SCL is high
+  twi_pullLow(TWI_SDA);
+  _delay_us(5);
+  twi_release(TWI_SCL);
+  _delay_us(5);
+  twi_release(TWI_SDA);
+  _delay_us(5);
+
+  twi_errors.recoveries++;
+  twi_init();
+}
+
+/* 
+ * Function twi_timeout
+ * Desc     abandons a transaction that missed its deadline
+ * Input    none
+ * Output   none
+ */
+static void twi_timeout(void)
+{
+  twi_errors.timeouts++;
+  twi_recover();
+}
+
+/* 
+ * Function twi_waitWhile
+ * Desc     waits while twi is in a state, spending a loop budget
+ * Input    state: the state to wait out
+ *          budget: the passes left before the deadline
+ * Output   1 .. twi left the state
+ *          0 .. the deadline passed
+ */
+static inline uint8_t twi_waitWhile(uint8_t state, uint32_t* budget)
+{
+  while(state == twi_state){
+    if(0 == (*budget)--){
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* 
+ * Function twi_waitReady
+ * Desc     waits for twi to finish whatever it is doing
+ * Input    budget: the passes left before the deadline
+ * Output   1 .. twi is ready
+ *          0 .. the deadline passed
+ */
+static inline uint8_t twi_waitReady(uint32_t* budget)
+{
+  while(TWI_READY != twi_state){
+    if(0 == (*budget)--){
+      return 0;
+    }
+  }
+  return 1;
+}
+
+#ifdef TWI_SLAVE
 /* 
  * Function twi_slaveInit
  * Desc     sets slave address and enables interrupt
@@ -101,34 +241,38 @@ void twi_setAddress(uint8_t address)
   // set twi slave address (skip over TWGCE bit)
   TWAR = address << 1;
 }
+#endif
 
 /* 
  * Function twi_readFrom
  * Desc     attempts to become twi bus master and read a
  *          series of bytes from a device on the bus
+ *          the interrupt stores each byte straight into data
  * Input    address: 7bit i2c device address
  *          data: pointer to byte array
  *          length: number of bytes to read into array
- * Output   number of bytes read
+ * Output   number of bytes read (0 if the deadline passed)
  */
 uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length)
 {
-  uint8_t i;
+  uint32_t budget = twi_timeoutLoops;
 
-  // ensure data will fit into buffer
-  if(TWI_BUFFER_LENGTH < length){
+  // there is nothing to nack after a read of no bytes
+  if(0 == length){
     return 0;
   }
 
   // wait until twi is ready, become master receiver
-  while(TWI_READY != twi_state){
-    continue;
+  if(!twi_waitReady(&budget)){
+    twi_timeout();
+    return 0;
   }
   twi_state = TWI_MRX;
   // reset error state (0xFF.. no error occured)
   twi_error = 0xFF;
 
   // initialize buffer iteration vars
+  twi_masterBuffer = data;
   twi_masterBufferIndex = 0;
   twi_masterBufferLength = length-1;  // This is not intuitive, read on...
   // On receive, the previously configured ACK/NACK setting is transmitted in
@@ -145,18 +289,19 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length)
   TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTA);
 
   // wait for read operation to complete
-  while(TWI_MRX == twi_state){
-    continue;
+  if(!twi_waitWhile(TWI_MRX, &budget)){
+    twi_timeout();
+    return 0;
   }
+  // the interrupt wrote data behind the compiler's back
+  __asm__ __volatile__("":::"memory");
+
+  if (twi_error == TW_MR_SLA_NACK)
+    twi_errors.nacks++;
 
   if (twi_masterBufferIndex < length)
     length = twi_masterBufferIndex;
 
-  // copy twi buffer to data
-  for(i = 0; i < length; ++i){
-    data[i] = twi_masterBuffer[i];
-  }
-        
   return length;
 }
 
@@ -164,42 +309,36 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length)
  * Function twi_writeTo
  * Desc     attempts to become twi bus master and write a
  *          series of bytes to a device on the bus
+ *          the interrupt sends each byte straight from data, so
+ *          if wait is 0, data must not change until twi is ready
  * Input    address: 7bit i2c device address
  *          data: pointer to byte array
  *          length: number of bytes in array
  *          wait: boolean indicating to wait for write or not
  * Output   0 .. success
- *          1 .. length to long for buffer
  *          2 .. address send, NACK received
  *          3 .. data send, NACK received
  *          4 .. other twi error (lost bus arbitration, bus error, ..)
+ *          5 .. the deadline passed, and the bus was recovered
  */
 uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait)
 {
-  uint8_t i;
-
-  // ensure data will fit into buffer
-  if(TWI_BUFFER_LENGTH < length){
-    return 1;
-  }
+  uint32_t budget = twi_timeoutLoops;
 
   // wait until twi is ready, become master transmitter
-  while(TWI_READY != twi_state){
-    continue;
+  if(!twi_waitReady(&budget)){
+    twi_timeout();
+    return 5;
   }
   twi_state = TWI_MTX;
   // reset error state (0xFF.. no error occured)
   twi_error = 0xFF;
 
   // initialize buffer iteration vars
+  twi_masterBuffer = data;
   twi_masterBufferIndex = 0;
   twi_masterBufferLength = length;
   
-  // copy data to twi buffer
-  for(i = 0; i < length; ++i){
-    twi_masterBuffer[i] = data[i];
-  }
-  
   // build sla+w, slave device address + w bit
   twi_slarw = TW_WRITE;
   twi_slarw |= address << 1;
@@ -208,13 +347,15 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
   TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTA);
 
   // wait for write operation to complete
-  while(wait && (TWI_MTX == twi_state)){
-    continue;
+  if(wait && !twi_waitWhile(TWI_MTX, &budget)){
+    twi_timeout();
+    return 5;
   }
   
   if (twi_error == 0xFF)
     return 0;   // success
-  else if (twi_error == TW_MT_SLA_NACK)
+  twi_errors.nacks += twi_error == TW_MT_SLA_NACK || twi_error == TW_MT_DATA_NACK;
+  if (twi_error == TW_MT_SLA_NACK)
     return 2;   // error: address send, nack received
   else if (twi_error == TW_MT_DATA_NACK)
     return 3;   // error: data send, nack received
@@ -222,6 +363,7 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
     return 4;   // other twi error
 }
 
+#ifdef TWI_SLAVE
 /* 
  * Function twi_transmit
  * Desc     fills slave tx buffer with data
@@ -276,6 +418,7 @@ void twi_attachSlaveTxEvent( void (*function)(void) )
 {
   twi_onSlaveTransmit = function;
 }
+#endif
 
 /* 
  * Function twi_reply
@@ -301,13 +444,21 @@ void twi_reply(uint8_t ack)
  */
 void twi_stop(void)
 {
+  uint32_t budget = twi_timeoutLoops;
+
   // send stop condition
   TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTO);
 
   // wait for stop condition to be exectued on bus
   // TWINT is not set after a stop condition!
+  // a slave holding SCL low stops it forever, so give up at the deadline
   while(TWCR & _BV(TWSTO)){
-    continue;
+    if(0 == budget--){
+      twi_errors.timeouts++;
+      TWCR = 0;
+      TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
+      break;
+    }
   }
 
   // update twi state
@@ -362,6 +513,7 @@ SIGNAL(TWI_vect)
       break;
     case TW_MT_ARB_LOST: // lost bus arbitration
       twi_error = TW_MT_ARB_LOST;
+      twi_errors.arbitration++;
       twi_releaseBus();
       break;
 
@@ -380,11 +532,15 @@ SIGNAL(TWI_vect)
     case TW_MR_DATA_NACK: // data received, nack sent
       // put final byte into buffer
       twi_masterBuffer[twi_masterBufferIndex++] = TWDR;
+      twi_stop();
+      break;
     case TW_MR_SLA_NACK: // address sent, nack received
+      twi_error = TW_MR_SLA_NACK;
       twi_stop();
       break;
     // TW_MR_ARB_LOST handled by TW_MT_ARB_LOST case
 
+#ifdef TWI_SLAVE
     // Slave Receiver
     case TW_SR_SLA_ACK:   // addressed, returned ack
     case TW_SR_GCALL_ACK: // addressed generally, returned ack
@@ -463,12 +619,14 @@ SIGNAL(TWI_vect)
       // leave slave receiver state
       twi_state = TWI_READY;
       break;
+#endif
 
     // All
     case TW_NO_INFO:   // no state information
       break;
     case TW_BUS_ERROR: // bus error, illegal stop/start
       twi_error = TW_BUS_ERROR;
+      twi_errors.busErrors++;
       twi_stop();
       break;
   }
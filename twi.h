@@ -24,17 +24,50 @@
 
   //#define ATMEGA8
 
-  #ifndef CPU_FREQ
-  #define CPU_FREQ 16000000L
+  #ifndef F_CPU
+  #define F_CPU 1000000UL
   #endif
 
+  // the bus clock asked for: 100kHz standard mode or 400kHz fast mode
   #ifndef TWI_FREQ
-  #define TWI_FREQ 100000L
+  #define TWI_FREQ 400000L
   #endif
 
+  // SCL = F_CPU / (16 + 2 * TWBR * prescaler).  TWI_PRESCALER holds the
+  // TWPS bits and TWI_BITRATE the TWBR value that come closest to
+  // TWI_FREQ without going over.  Below 16 times TWI_FREQ the clock is
+  // too slow for it, and the bus runs as fast as it can, at F_CPU / 16
+  #if F_CPU < 16 * TWI_FREQ
+  #define TWI_PRESCALER 0
+  #define TWI_BITRATE 0
+  #elif (F_CPU / TWI_FREQ - 15) / 2 <= 255
+  #define TWI_PRESCALER 0
+  #define TWI_BITRATE ((F_CPU / TWI_FREQ - 15) / 2)
+  #elif (F_CPU / TWI_FREQ - 9) / 8 <= 255
+  #define TWI_PRESCALER 1
+  #define TWI_BITRATE ((F_CPU / TWI_FREQ - 9) / 8)
+  #elif (F_CPU / TWI_FREQ + 15) / 32 <= 255
+  #define TWI_PRESCALER 2
+  #define TWI_BITRATE ((F_CPU / TWI_FREQ + 15) / 32)
+  #else
+  #define TWI_PRESCALER 3
+  #define TWI_BITRATE ((F_CPU / TWI_FREQ + 111) / 128)
+  #endif
+
+  // a transaction that hasn't finished within this many microseconds
+  // is abandoned, and the bus is recovered
+  #ifndef TWI_TIMEOUT_US
+  #define TWI_TIMEOUT_US 5000L
+  #endif
+
+  // master transfers read and write the caller's buffer directly, so
+  // buffers are only needed for slave mode, which is only compiled in
+  // when TWI_SLAVE is defined
+  #ifdef TWI_SLAVE
   #ifndef TWI_BUFFER_LENGTH
   #define TWI_BUFFER_LENGTH 32
   #endif
+  #endif
 
   #define TWI_READY 0
   #define TWI_MRX   1
@@ -42,13 +75,26 @@
   #define TWI_SRX   3
   #define TWI_STX   4
   
+  // counts of failed transactions, since twi_init()
+  typedef struct {
+    uint16_t timeouts;     // abandoned after TWI_TIMEOUT_US
+    uint16_t nacks;        // address or data not acknowledged
+    uint16_t arbitration;  // another master took the bus
+    uint16_t busErrors;    // illegal start or stop seen
+    uint16_t recoveries;   // times a stuck slave was clocked free
+  } twi_errors_t;
+
   void twi_init(void);
-  void twi_setAddress(uint8_t);
+  void twi_setTimeout(uint16_t);
+  void twi_getErrors(twi_errors_t*);
   uint8_t twi_readFrom(uint8_t, uint8_t*, uint8_t);
   uint8_t twi_writeTo(uint8_t, uint8_t*, uint8_t, uint8_t);
+  #ifdef TWI_SLAVE
+  void twi_setAddress(uint8_t);
   uint8_t twi_transmit(uint8_t*, uint8_t);
   void twi_attachSlaveRxEvent( void (*)(uint8_t*, int) );
   void twi_attachSlaveTxEvent( void (*)(void) );
+  #endif
   void twi_reply(uint8_t);
   void twi_stop(void);
   void twi_releaseBus(void);
@@ -1,57 +1,394 @@
 /**This library is written to interface with the soundFX
- * board from ADAFruit.  Because that board has all the
- * necessary audio on it, all this library does is activate
- * the necessary pins.   
+ * board from ADAFruit over its UART, or, when VOICE_PCM is defined,
+ * with the ADPCM engine in audio.cpp instead of a sound board.
+ * The board's RX is wired to TXD (D1), its TX to RXD (D0), and its
+ * ACT output to D6.  The board understands single line commands:
+ * "#n" plays track n, "q" stops playing, and "+" or "-" change the
+ * volume by one step, after which it replies with the new volume.
  */
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
 #include "voice.h"
+#include "clock.h"
+#ifdef VOICE_PCM
+#include "audio.h"
+#include "clips.h"
+#endif
 
-/**This function initializes the voice box.  It sets the outputs
- * to 0 so that it begins not triggering a sound from the soundFX board
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
+
+#define DEFAULT_VOLUME 204
+#define NO_TRACK 0xFF
+
+static unsigned char targetVolume=DEFAULT_VOLUME;
+
+#ifdef VOICE_PCM
+
+/**Tracks are clip numbers, and the engine starts and stops at once.
+ * With the asset store, tracks past the clips built into the program
+ * are streamed from the blobs named TRACK00 to TRACK99.
  */
 void setUpVoice()
 {
-  //Initialize the three pins as high, since low initialization will play a tone
-  PORTD |= 0x0D;
-  //Enable pins D0, D1, and D3 as output
-  DDRD |= 0x0D;
+  DDRD|=VOICE_ENABLE_PIN;
+  PORTD|=VOICE_ENABLE_PIN;
+  setUpAudio();
 }
 
-/**Set Pin D3 to 5V, disabling the soundFX board
+/**The output is disconnected from the timer and held low, so the
+ * amplifier's input doesn't sit at the silence level while it is off
  */
-void disableAccelerometerSound()
-  {PORTD |= 0x08;}
+static void stopOutput()
+{
+  audioStop();
+  TCCR0A&=~((1<<COM0B1)|(1<<COM0B0));
+  PORTD&=~0x20;
+}
+
+//The engine is ready as soon as it is set up
+static int boardReady()
+  {return 1;}
 
-/**Set Pin D3 to 0V, enabling the soundFX board
+int voicePlaying()
+  {return audioPlaying();}
+
+static int sendPlay(unsigned char track,int interrupting)
+{
+#ifdef ASSET_STORE
+  if(track>=AUDIO_CLIPS)
+  {
+    char name[]="TRACK00";
+    assetStream stream;
+    name[5]+=track/10;
+    name[6]+=track%10;
+    if(openAsset(name,&stream)) audioPlayAsset(&stream);
+    return 1;
+  }
+#endif
+  audioPlay(track);
+  return 1;
+}
+
+static int sendStop()
+{
+  audioStop();
+  return 1;
+}
+
+//The engine's volume runs from 0-255 rather than the board's 0-204
+static void sendVolume()
+  {audioSetVolume(targetVolume+(targetVolume>>2));}
+
+#else
+
+//The ACT pin, which is low while a track plays
+#define ACT_PIN 0x40
+
+//The number of bytes of commands that can wait to be sent
+#define VOICE_TX_LENGTH 16
+
+//The milliseconds given to the board to reply to a volume step
+#define VOICE_VOLUME_MS 64
+
+/**The transmit queue.  Only voiceSend() moves txHead and only the
+ * interrupt moves txTail, so neither needs to be protected.
  */
-void enableAccelerometerSound()
-  {PORTD &= 0xF7;}
+static unsigned char txBuffer[VOICE_TX_LENGTH];
+static volatile unsigned char txHead;
+static volatile unsigned char txTail;
 
-/**Set Pin D2 to 5V, disabling the soundFX board
+/**Returns the number of bytes free in the transmit queue
  */
-void enableButtonSound()
-  {PORTD &= 0xFB;}
+static unsigned char txFree()
+  {return (unsigned char)(txTail-txHead-1)&(VOICE_TX_LENGTH-1);}
 
-/**Set Pin D2 to 0V, enabling the soundFX board
+/**Queues a command line for the board.  The whole command is queued or
+ * none of it is, so the board never sees half a command.  Returns 0 if
+ * there wasn't room.
  */
-void disableButtonSound()
-  {PORTD |= 0x04;}
+static int voiceSend(const char* command)
+{
+  unsigned char length=0;
+  while(command[length]) length++;
+  if(txFree()<length+1) return 0;
+  unsigned char head=txHead;
+  for(unsigned char i=0;i<length;i++)
+  {
+    txBuffer[head]=command[i];
+    head=(head+1)&(VOICE_TX_LENGTH-1);
+  }
+  txBuffer[head]='\n';
+  txHead=(head+1)&(VOICE_TX_LENGTH-1);
+  //Let the interrupt start sending
+  UCSR0B|=(1<<UDRIE0);
+  return 1;
+}
 
-/**Set Pin D0 to 5V, disabling the soundFX board
+ISR(USART_UDRE_vect)
+{
+  unsigned char tail=txTail;
+  if(tail==txHead)
+  {
+    //Nothing left to send
+    UCSR0B&=~(1<<UDRIE0);
+    return;
+  }
+  UDR0=txBuffer[tail];
+  txTail=(tail+1)&(VOICE_TX_LENGTH-1);
+}
+
+/**The board answers a volume change with the new volume on its own
+ * line.  Any line that is only digits is taken to be that volume.
  */
-void enableTemperatureSound()
-  {PORTD &= 0xFE;}
+static volatile unsigned char boardVolume=DEFAULT_VOLUME;
+static unsigned int volumeSent;
+static unsigned int rxNumber;
+static unsigned char rxDigits;
+static unsigned char rxOther;
 
-/**Set Pin D0 to 0V, enabling the soundFX board
+ISR(USART_RX_vect)
+{
+  unsigned char c=UDR0;
+  if(c>='0' && c<='9')
+  {
+    rxNumber=rxNumber*10+(c-'0');
+    rxDigits++;
+  }
+  else if(c=='\n' || c=='\r')
+  {
+    if(rxDigits && !rxOther && rxNumber<=DEFAULT_VOLUME) boardVolume=rxNumber;
+    rxNumber=0;
+    rxDigits=0;
+    rxOther=0;
+  }
+  else rxOther=1;
+}
+
+//When the board was last powered, and whether it may still be starting
+static unsigned int poweredOn;
+static unsigned char booting;
+
+/**This function initializes the voice box.  The UART is set to 9600
+ * baud, 8 data bits, no parity and 1 stop bit.
  */
-void disableTemperatureSound()
-  {PORTD |= 0x01;}
+void setUpVoice()
+{
+  DDRD|=VOICE_ENABLE_PIN;
+  PORTD|=VOICE_ENABLE_PIN;
+  poweredOn=clockNow();
+  booting=1;
 
-void disableAudio()
+  //Double speed mode keeps the baud error small at a 1MHz clock
+  UCSR0A=(1<<U2X0);
+  UBRR0=(F_CPU/(8UL*VOICE_BAUD))-1;
+  UCSR0C=(1<<UCSZ01)|(1<<UCSZ00);
+  UCSR0B=(1<<RXEN0)|(1<<TXEN0)|(1<<RXCIE0);
+
+  //ACT is an open collector output, so use the internal pull up
+  DDRD&=~ACT_PIN;
+  PORTD|=ACT_PIN;
+}
+
+int voicePlaying()
+  {return !(PIND & ACT_PIN);}
+
+/**Returns 1 once the board has had VOICE_BOOT_MS to start up.  The
+ * answer is kept, so the 16 bit clock wrapping can't take it back
+ */
+static int boardReady()
+{
+  if(booting && clockElapsed(poweredOn,VOICE_BOOT_MS)) booting=0;
+  return !booting;
+}
+
+/**The board restarts when it is powered again, so it is assumed to be
+ * back at its default volume, and the TX pin and the pull up on ACT are
+ * turned off, so they don't power it through its inputs
+ */
+static void stopOutput()
+{
+  while(UCSR0B&(1<<UDRIE0));
+  _delay_ms(VOICE_DRAIN_MS);
+  UCSR0B=0;
+  DDRD&=~0x02;
+  PORTD&=~(0x02|ACT_PIN);
+  boardVolume=DEFAULT_VOLUME;
+}
+
+/**Queues the command to play a track.  Stopping first makes the board
+ * drop the track it is playing.  Returns 0 if there wasn't room.
+ */
+static int sendPlay(unsigned char track,int interrupting)
+{
+  char command[]="#00";
+  command[1]='0'+track/10;
+  command[2]='0'+track%10;
+  if(track<10)
   {
-    disableAccelerometerSound();
-    disableTemperatureSound();
-    disableButtonSound();
+    command[1]=command[2];
+    command[2]=0;
   }
+  if(txFree()<sizeof(command)+2) return 0;
+  if(interrupting) voiceSend("q");
+  voiceSend(command);
+  return 1;
+}
+
+static int sendStop()
+  {return voiceSend("q");}
+
+/**Only one volume step is sent at a time, and the reply to it updates
+ * boardVolume before the next step is decided
+ */
+static void sendVolume()
+{
+  if(!clockElapsed(volumeSent,VOICE_VOLUME_MS)) return;
+  if(targetVolume>boardVolume+1) {if(voiceSend("+")) volumeSent=clockNow();}
+  else if(targetVolume+1<boardVolume) {if(voiceSend("-")) volumeSent=clockNow();}
+}
+
+#endif
+
+
+//The milliseconds the board is given to start a track, before
+//the track is assumed to have finished
+#define VOICE_START_MS 64
+
+/**The track queue, kept in order of priority, so the next track to play
+ * is always at the front.
+ */
+struct queuedTrack
+{
+  unsigned char track;
+  unsigned char priority;
+};
+static queuedTrack queue[VOICE_QUEUE_LENGTH];
+static unsigned char queueLength;
+
+static unsigned char currentTrack=NO_TRACK;
+static unsigned char currentPriority;
+static unsigned int trackStarted;
+static unsigned char stopPending;
+
+/**Removes entry i from the queue
+ */
+static void dequeue(unsigned char i)
+{
+  queueLength--;
+  for(;i<queueLength;i++) queue[i]=queue[i+1];
+}
+
+/**Adds a track to the queue behind every track of the same or higher
+ * priority.  If the track is already waiting, it keeps its place unless
+ * the new priority is higher.  Only two digits are sent, and NO_TRACK
+ * must never be queued, so larger numbers are refused.
+ */
+int playTrack(unsigned char track, unsigned char priority)
+{
+  if(track>99) return 0;
+  unsigned char i;
+  for(i=0;i<queueLength;i++)
+  {
+    if(queue[i].track!=track) continue;
+    if(queue[i].priority>=priority) return 1;
+    dequeue(i);
+    break;
+  }
+  if(queueLength>=VOICE_QUEUE_LENGTH) return 0;
+  for(i=queueLength;i>0 && queue[i-1].priority<priority;i--) queue[i]=queue[i-1];
+  queue[i].track=track;
+  queue[i].priority=priority;
+  queueLength++;
+  return 1;
+}
+
+void stopTrack(unsigned char track)
+{
+  for(unsigned char i=0;i<queueLength;)
+  {
+    if(queue[i].track==track) dequeue(i);
+    else i++;
+  }
+  if(currentTrack==track) stopPending=1;
+}
+
+void setVolume(unsigned char volume)
+  {targetVolume=volume;}
+
+/**Sends a pending stop first, then starts the front of the queue once
+ * the board is idle (or at once, if it beats the priority of the track
+ * being played), then walks the volume.  A command that doesn't fit in
+ * the transmit queue is simply tried again next tick, and nothing is sent
+ * while the board is starting up, so tracks wait in the queue.  Played
+ * from flash, the audio is decoded ahead here too.
+ */
+void voiceTick()
+{
+  if(!boardReady()) return;
+  if(currentTrack!=NO_TRACK && clockElapsed(trackStarted,VOICE_START_MS) && !voicePlaying())
+    currentTrack=NO_TRACK;
+
+  if(stopPending)
+  {
+    if(!sendStop()) return;
+    stopPending=0;
+    currentTrack=NO_TRACK;
+  }
+
+  if(queueLength && (currentTrack==NO_TRACK || queue[0].priority>currentPriority))
+  {
+    if(sendPlay(queue[0].track,currentTrack!=NO_TRACK))
+    {
+      currentTrack=queue[0].track;
+      currentPriority=queue[0].priority;
+      trackStarted=clockNow();
+      dequeue(0);
+    }
+  }
+
+  sendVolume();
+#ifdef VOICE_PCM
+  audioFill();
+#endif
+}
+
+void voiceSleep()
+{
+  queueLength=0;
+  stopPending=0;
+  currentTrack=NO_TRACK;
+  stopOutput();
+  PORTD&=~VOICE_ENABLE_PIN;
+}
+
+void voiceWake()
+  {setUpVoice();}
+
+void enableAccelerometerSound()
+  {playTrack(TRACK_ACCELEROMETER,PRIORITY_REACTION);}
+
+void disableAccelerometerSound()
+  {stopTrack(TRACK_ACCELEROMETER);}
+
+void enableButtonSound()
+  {playTrack(TRACK_BUTTON,PRIORITY_REACTION);}
+
+void disableButtonSound()
+  {stopTrack(TRACK_BUTTON);}
 
-
+void enableTemperatureSound()
+  {playTrack(TRACK_TEMPERATURE,PRIORITY_AMBIENT);}
+
+void disableTemperatureSound()
+  {stopTrack(TRACK_TEMPERATURE);}
+
+/**Empties the queue and stops whatever is playing
+ */
+void disableAudio()
+{
+  queueLength=0;
+  if(currentTrack!=NO_TRACK) stopPending=1;
+}
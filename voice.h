@@ -1,33 +1,88 @@
 /**This library is written to interface with the soundFX
- * board from ADAFruit.  Because that board has all the
- * necessary audio on it, all this library does is activate
- * the necessary pins.   
+ * board from ADAFruit in its UART mode (UG held low at power on).
+ * Tracks are requested by number with a priority, and are played
+ * from a small queue.  Commands are sent to the board by the UART's
+ * data register empty interrupt, so nothing here ever blocks.
  */
 
-//This function initializes the voice box.  It sets the outputs
-//to 0 so that it begins not triggering a sound from the soundFX board
+//The UART runs at the board's fixed 9600 baud
+#define VOICE_BAUD 9600
+
+//Port D7 switches the power to the sound board (or, with VOICE_PCM, to
+//the amplifier).  It is high while the robot is awake
+#define VOICE_ENABLE_PIN 0x80
+
+//The milliseconds the UART is given to send the last bytes queued, which
+//are two bytes, at most, at 9600 baud
+#define VOICE_DRAIN_MS 3
+
+//The milliseconds the board is given to start up once it is powered,
+//before any command is sent.  Until then it would drop them.  This is an
+//allowance, not a measured figure
+#define VOICE_BOOT_MS 1000
+
+//How many requested tracks can wait to be played
+#define VOICE_QUEUE_LENGTH 4
+
+//Track numbers of the sounds on the soundFX board
+#define TRACK_ACCELEROMETER 0
+#define TRACK_BUTTON 1
+#define TRACK_TEMPERATURE 2
+
+//Priorities for playTrack().  A higher priority track interrupts a lower
+//one that is playing; otherwise tracks wait their turn
+#define PRIORITY_AMBIENT 1
+#define PRIORITY_REACTION 2
+#define PRIORITY_ALERT 3
+
+//This function initializes the voice box.  It powers the board, and sets
+//up the UART and the ACT input, which the board pulls low while a track
+//is playing
 void setUpVoice();
 
-//Set Pin D3 to 5V, disabling the soundFX board
-void disableAccelerometerSound();
+//Empties the queue, waits for the UART to finish, and turns the board off,
+//so nothing is left driving or drawing current through its pins
+void voiceSleep();
+
+//Turns the board back on after voiceSleep().  Nothing is sent to it
+//until VOICE_BOOT_MS later
+void voiceWake();
 
-//Set Pin D3 to 0V, enabling the soundFX board
+//Queue a track (0-99) to be played.  Returns 0 if the queue is full or
+//the track is out of range
+int playTrack(unsigned char track, unsigned char priority);
+
+//Remove a track from the queue, and stop it if it is playing
+void stopTrack(unsigned char track);
+
+//Sets the board's volume (0-204, in steps of 2).  The volume is walked
+//there one step per voiceTick()
+void setVolume(unsigned char volume);
+
+//Returns 1 if the board is playing a track, 0 otherwise
+int voicePlaying();
+
+//Sends queued commands to the board.  Call once per tick
+void voiceTick();
+
+//Play the accelerometer sound
 void enableAccelerometerSound();
 
-//Set Pin D2 to 5V, disabling the soundFX board
+//Stop the accelerometer sound
+void disableAccelerometerSound();
+
+//Play the button sound
 void enableButtonSound();
 
-//Set Pin D2 to 0V, enabling the soundFX board
+//Stop the button sound
 void disableButtonSound();
 
-//Set Pin D0 to 5V, disabling the soundFX board
+//Play the temperature sound
 void enableTemperatureSound();
 
-//Set Pin D0 to 0V, enabling the soundFX board
+//Stop the temperature sound
 void disableTemperatureSound();
 
-//Turn off all audio
+//Turn off all audio and empty the queue
 void disableAudio();
 
-
-